@@ -916,3 +916,1077 @@ CREATE OPERATOR CLASS sparsevec_l1_ops
 	OPERATOR 1 <+> (sparsevec, sparsevec) FOR ORDER BY float_ops,
 	FUNCTION 1 l1_distance(sparsevec, sparsevec),
 	FUNCTION 3 hnsw_sparsevec_support(internal);
+
+-- tuning functions
+
+CREATE FUNCTION vector_index_info(index regclass, OUT tbl regclass, OUT expr text, OUT am name, OUT op text, OUT nsp name) AS $$
+	SELECT i.indrelid::regclass, pg_get_indexdef(i.indexrelid, 1, true), a.amname,
+		format('OPERATOR(%I.%s)', n.nspname, o.oprname), n.nspname
+	FROM pg_index i
+	INNER JOIN pg_class c ON c.oid = i.indexrelid
+	INNER JOIN pg_am a ON a.oid = c.relam
+	INNER JOIN pg_opclass oc ON oc.oid = i.indclass[0]
+	INNER JOIN pg_amop ao ON ao.amopfamily = oc.opcfamily AND ao.amoppurpose = 'o'
+	INNER JOIN pg_operator o ON o.oid = ao.amopopr
+	INNER JOIN pg_namespace n ON n.oid = o.oprnamespace
+	WHERE i.indexrelid = index
+	LIMIT 1
+$$ LANGUAGE SQL STABLE STRICT;
+
+CREATE FUNCTION vector_autotune(index regclass, queries anyarray, k int, target_recall float8) RETURNS int AS $$
+DECLARE
+	am name;
+	tbl regclass;
+	expr text;
+	op text;
+	nsp name;
+	plan text;
+	setting text;
+	option text;
+	prev_setting text;
+	prev_seqscan text;
+	exact_sql text;
+	approx_sql text;
+	truth tid[] := '{}';
+	offsets int[] := '{}';
+	results tid[];
+	matches bigint;
+	hits bigint;
+	total bigint;
+	low int := 1;
+	high int;
+	mid int;
+BEGIN
+	IF k < 1 THEN
+		RAISE EXCEPTION 'k must be greater than zero';
+	END IF;
+
+	IF target_recall <= 0 OR target_recall > 1 THEN
+		RAISE EXCEPTION 'target_recall must be greater than 0 and less than or equal to 1';
+	END IF;
+
+	-- the extension may not be on the search path
+	EXECUTE format('SELECT * FROM %s.vector_index_info($1)', (SELECT extnamespace::regnamespace FROM pg_extension WHERE extname = 'vector'))
+		INTO tbl, expr, am, op, nsp USING index;
+
+	IF am = 'hnsw' THEN
+		setting := 'hnsw.ef_search';
+		option := 'ef_search';
+		high := 1000;
+	ELSIF am = 'ivfflat' THEN
+		setting := 'ivfflat.probes';
+		option := 'probes';
+		SELECT coalesce(max(split_part(r, '=', 2)::int), 100) INTO high
+			FROM pg_class, unnest(reloptions) r WHERE oid = index AND r LIKE 'lists=%';
+	ELSE
+		RAISE EXCEPTION 'index must use hnsw or ivfflat';
+	END IF;
+
+	-- the index option is a minimum, so tune with the setting from there
+	SELECT greatest(coalesce(max(split_part(r, '=', 2)::int), 1), 1) INTO low
+		FROM pg_class, unnest(reloptions) r WHERE oid = index AND r LIKE option || '=%';
+	high := greatest(high, low);
+
+	-- adding zero prevents the index from being used for exact results
+	exact_sql := format('SELECT array_agg(ctid) FROM (SELECT ctid FROM %s ORDER BY ((%s) %s $1) + 0 LIMIT $2) t', tbl, expr, op);
+	approx_sql := format('SELECT array_agg(ctid) FROM (SELECT ctid FROM %s ORDER BY (%s) %s $1 LIMIT $2) t', tbl, expr, op);
+
+	FOR i IN coalesce(array_lower(queries, 1), 1) .. coalesce(array_upper(queries, 1), 0) LOOP
+		EXECUTE exact_sql INTO results USING queries[i], k;
+		offsets := offsets || (coalesce(array_length(truth, 1), 0) + 1);
+		truth := truth || coalesce(results, '{}');
+	END LOOP;
+	offsets := offsets || (coalesce(array_length(truth, 1), 0) + 1);
+
+	prev_setting := current_setting(setting);
+	prev_seqscan := current_setting('enable_seqscan');
+	PERFORM set_config('enable_seqscan', 'off', true);
+
+	-- another index on the same expression could be chosen instead
+	IF array_length(offsets, 1) > 1 THEN
+		EXECUTE 'EXPLAIN (FORMAT JSON) ' || approx_sql INTO plan USING queries[array_lower(queries, 1)], k;
+		IF strpos(plan, format('"Index Name": %s', to_json((SELECT relname FROM pg_class WHERE oid = index)::text))) = 0 THEN
+			RAISE EXCEPTION 'queries do not use index "%"', index;
+		END IF;
+	END IF;
+
+	-- find the smallest value that meets the target
+	WHILE low < high LOOP
+		mid := (low + high) / 2;
+		PERFORM set_config(setting, mid::text, true);
+
+		hits := 0;
+		total := 0;
+		FOR j IN 1 .. array_length(offsets, 1) - 1 LOOP
+			EXECUTE approx_sql INTO results USING queries[array_lower(queries, 1) + j - 1], k;
+			SELECT count(*) INTO matches FROM unnest(results) r WHERE r = ANY (truth[offsets[j]:offsets[j + 1] - 1]);
+			hits := hits + matches;
+			total := total + offsets[j + 1] - offsets[j];
+		END LOOP;
+
+		IF total = 0 OR hits >= target_recall * total THEN
+			high := mid;
+		ELSE
+			low := mid + 1;
+		END IF;
+	END LOOP;
+
+	PERFORM set_config(setting, prev_setting, true);
+	PERFORM set_config('enable_seqscan', prev_seqscan, true);
+
+	EXECUTE format('ALTER INDEX %s SET (%s = %s)', index, option, high);
+
+	RETURN high;
+END;
+$$ LANGUAGE plpgsql;
+
+CREATE FUNCTION vector_index_advise(tbl regclass, col name, kind text, opclass name DEFAULT NULL, sample_size int DEFAULT 10000, k int DEFAULT 10)
+RETURNS TABLE (index_options text, search_option text, build_time interval, index_size bigint, recall float8, query_time interval, intrinsic_dimension float8) AS $$
+DECLARE
+	op text;
+	total_rows float8;
+	sample_rows bigint;
+	scale float8;
+	qids tid[];
+	truth tid[] := '{}';
+	offsets int[] := '{}';
+	results tid[];
+	dists float8[];
+	ratio_sum float8 := 0;
+	ratio_count int := 0;
+	exact_sql text;
+	approx_sql text;
+	setting text;
+	prev_setting text;
+	prev_seqscan text;
+	build_options text[];
+	full_values int[];
+	sample_values int[];
+	base_lists int;
+	started timestamptz;
+	elapsed interval;
+	hits bigint;
+	matches bigint;
+	total bigint;
+	sample_name name := 'vector_index_advise_' || replace(gen_random_uuid()::text, '-', '');
+	sample_tbl text := format('pg_temp.%I', sample_name);
+	sample_idx text := format('pg_temp.%I', sample_name || '_idx');
+BEGIN
+	IF kind NOT IN ('hnsw', 'ivfflat') THEN
+		RAISE EXCEPTION 'kind must be hnsw or ivfflat';
+	END IF;
+
+	IF sample_size < 2 THEN
+		RAISE EXCEPTION 'sample_size must be greater than one';
+	END IF;
+
+	IF k < 1 THEN
+		RAISE EXCEPTION 'k must be greater than zero';
+	END IF;
+
+	IF opclass IS NULL THEN
+		SELECT CASE WHEN t.typname = 'bit' THEN 'bit_hamming_ops' ELSE t.typname || '_l2_ops' END INTO opclass
+		FROM pg_attribute a
+		INNER JOIN pg_type t ON t.oid = a.atttypid
+		WHERE a.attrelid = tbl AND a.attname = col AND NOT a.attisdropped;
+	END IF;
+
+	-- sample the column
+	SELECT reltuples INTO total_rows FROM pg_class WHERE oid = tbl;
+	IF total_rows <= 0 THEN
+		EXECUTE format('SELECT count(*) FROM %s', tbl) INTO total_rows;
+	END IF;
+
+	-- indexes are built on the sample, so it must be a table (with a unique name)
+	EXECUTE format('CREATE TEMP TABLE %I ON COMMIT DROP AS SELECT %I AS v FROM %s TABLESAMPLE BERNOULLI (%s) WHERE %I IS NOT NULL LIMIT %s',
+		sample_name, col, tbl, least(100, 110.0 * sample_size / greatest(total_rows, 1)), col, sample_size);
+
+	EXECUTE format('SELECT count(*) FROM %s', sample_tbl) INTO sample_rows;
+	IF sample_rows < 2 THEN
+		RAISE EXCEPTION 'not enough rows to sample';
+	END IF;
+	scale := greatest(total_rows / sample_rows, 1);
+
+	-- use rows from the sample as queries
+	EXECUTE format('SELECT array_agg(ctid) FROM (SELECT ctid FROM %s ORDER BY random() LIMIT 100) t', sample_tbl) INTO qids;
+
+	-- candidate parameters for the full table
+	IF kind = 'hnsw' THEN
+		setting := 'hnsw.ef_search';
+		build_options := ARRAY['m = 8, ef_construction = 32', 'm = 16, ef_construction = 64', 'm = 32, ef_construction = 128'];
+	ELSE
+		setting := 'ivfflat.probes';
+		base_lists := greatest(CASE WHEN total_rows > 1000000 THEN sqrt(total_rows) ELSE total_rows / 1000 END, 1)::int;
+		build_options := ARRAY[format('lists = %s', greatest(base_lists / 2, 1)), format('lists = %s', base_lists), format('lists = %s', least(base_lists * 2, 32768))];
+	END IF;
+
+	prev_setting := current_setting(setting);
+	prev_seqscan := current_setting('enable_seqscan');
+	PERFORM set_config('enable_seqscan', 'off', true);
+
+	FOREACH index_options IN ARRAY build_options LOOP
+		IF kind = 'hnsw' THEN
+			full_values := ARRAY[10, 20, 40, 80, 160, 320];
+			sample_values := full_values;
+			started := clock_timestamp();
+			EXECUTE format('CREATE INDEX %I ON %s USING hnsw (v %I) WITH (%s)', sample_name || '_idx', sample_tbl, opclass, index_options);
+			elapsed := clock_timestamp() - started;
+
+			-- builds are roughly n log n
+			build_time := elapsed * scale * greatest(ln(greatest(total_rows, 2)) / ln(sample_rows), 1);
+		ELSE
+			base_lists := split_part(index_options, '= ', 2)::int;
+			full_values := ARRAY[1, greatest(ceil(sqrt(base_lists))::int, 1), greatest(base_lists / 10, 1)];
+			SELECT array_agg(greatest(round(p / scale)::int, 1)) INTO sample_values FROM unnest(full_values) p;
+			started := clock_timestamp();
+			EXECUTE format('CREATE INDEX %I ON %s USING ivfflat (v %I) WITH (lists = %s)', sample_name || '_idx', sample_tbl, opclass, greatest(round(base_lists / scale)::int, 1));
+			elapsed := clock_timestamp() - started;
+
+			-- assigning tuples is linear
+			build_time := elapsed * scale;
+		END IF;
+
+		index_size := (pg_relation_size(sample_idx::regclass) * scale)::bigint;
+
+		-- get exact results once the operator for the opclass is known
+		IF op IS NULL THEN
+			EXECUTE format('SELECT op FROM %s.vector_index_info($1)', (SELECT extnamespace::regnamespace FROM pg_extension WHERE extname = 'vector'))
+				INTO op USING sample_idx::regclass;
+
+			IF op IS NULL THEN
+				RAISE EXCEPTION 'operator class "%" does not support ordering', opclass;
+			END IF;
+
+			-- adding zero prevents an index from being used for exact results
+			exact_sql := format('SELECT array_agg(ctid ORDER BY d), array_agg(d ORDER BY d) FROM (SELECT s.ctid, (s.v %s q.v) + 0 AS d FROM %s s, (SELECT v FROM %s WHERE ctid = $1) q ORDER BY 2 LIMIT $2) t', op, sample_tbl, sample_tbl);
+			approx_sql := format('SELECT array_agg(ctid) FROM (SELECT ctid FROM %s ORDER BY v %s (SELECT v FROM %s WHERE ctid = $1) LIMIT $2) t', sample_tbl, op, sample_tbl);
+
+			FOR i IN 1 .. array_length(qids, 1) LOOP
+				EXECUTE exact_sql INTO results, dists USING qids[i], greatest(k, 3);
+				offsets := offsets || (coalesce(array_length(truth, 1), 0) + 1);
+				truth := truth || coalesce(results[1:k], '{}');
+
+				-- two nearest neighbors estimator (the query itself is first)
+				IF dists[2] > 0 AND dists[3] > dists[2] THEN
+					ratio_sum := ratio_sum + ln(dists[3] / dists[2]);
+					ratio_count := ratio_count + 1;
+				END IF;
+			END LOOP;
+			offsets := offsets || (coalesce(array_length(truth, 1), 0) + 1);
+
+			intrinsic_dimension := CASE WHEN ratio_sum > 0 THEN ratio_count / ratio_sum END;
+		END IF;
+
+		FOR j IN 1 .. array_length(full_values, 1) LOOP
+			PERFORM set_config(setting, sample_values[j]::text, true);
+
+			hits := 0;
+			total := 0;
+			started := clock_timestamp();
+			FOR i IN 1 .. array_length(qids, 1) LOOP
+				EXECUTE approx_sql INTO results USING qids[i], k;
+				SELECT count(*) INTO matches FROM unnest(results) r WHERE r = ANY (truth[offsets[i]:offsets[i + 1] - 1]);
+				hits := hits + matches;
+				total := total + offsets[i + 1] - offsets[i];
+			END LOOP;
+
+			search_option := format('%s = %s', setting, full_values[j]);
+			recall := hits::float8 / greatest(total, 1);
+			query_time := (clock_timestamp() - started) / array_length(qids, 1);
+			RETURN NEXT;
+		END LOOP;
+
+		EXECUTE format('DROP INDEX %s', sample_idx);
+	END LOOP;
+
+	PERFORM set_config(setting, prev_setting, true);
+	PERFORM set_config('enable_seqscan', prev_seqscan, true);
+
+	EXECUTE format('DROP TABLE %s', sample_tbl);
+END;
+$$ LANGUAGE plpgsql;
+
+-- clustering functions
+
+CREATE FUNCTION vector_kmeans_accum(internal, vector, integer) RETURNS internal
+	AS 'MODULE_PATHNAME' LANGUAGE C PARALLEL SAFE;
+
+CREATE FUNCTION vector_kmeans_accum(internal, vector, integer, integer) RETURNS internal
+	AS 'MODULE_PATHNAME' LANGUAGE C PARALLEL SAFE;
+
+CREATE FUNCTION halfvec_kmeans_accum(internal, halfvec, integer) RETURNS internal
+	AS 'MODULE_PATHNAME' LANGUAGE C PARALLEL SAFE;
+
+CREATE FUNCTION halfvec_kmeans_accum(internal, halfvec, integer, integer) RETURNS internal
+	AS 'MODULE_PATHNAME' LANGUAGE C PARALLEL SAFE;
+
+CREATE FUNCTION vector_kmeans_combine(internal, internal) RETURNS internal
+	AS 'MODULE_PATHNAME' LANGUAGE C PARALLEL SAFE;
+
+CREATE FUNCTION vector_kmeans_serial(internal) RETURNS bytea
+	AS 'MODULE_PATHNAME' LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION vector_kmeans_deserial(bytea, internal) RETURNS internal
+	AS 'MODULE_PATHNAME' LANGUAGE C STRICT PARALLEL SAFE;
+
+CREATE FUNCTION vector_kmeans_final(internal) RETURNS vector[]
+	AS 'MODULE_PATHNAME' LANGUAGE C PARALLEL SAFE;
+
+CREATE FUNCTION halfvec_kmeans_final(internal) RETURNS halfvec[]
+	AS 'MODULE_PATHNAME', 'vector_kmeans_final' LANGUAGE C PARALLEL SAFE;
+
+CREATE AGGREGATE vector_kmeans(vector, integer) (
+	SFUNC = vector_kmeans_accum,
+	STYPE = internal,
+	FINALFUNC = vector_kmeans_final,
+	COMBINEFUNC = vector_kmeans_combine,
+	SERIALFUNC = vector_kmeans_serial,
+	DESERIALFUNC = vector_kmeans_deserial,
+	PARALLEL = SAFE
+);
+
+CREATE AGGREGATE vector_kmeans(vector, integer, integer) (
+	SFUNC = vector_kmeans_accum,
+	STYPE = internal,
+	FINALFUNC = vector_kmeans_final,
+	COMBINEFUNC = vector_kmeans_combine,
+	SERIALFUNC = vector_kmeans_serial,
+	DESERIALFUNC = vector_kmeans_deserial,
+	PARALLEL = SAFE
+);
+
+CREATE AGGREGATE vector_kmeans(halfvec, integer) (
+	SFUNC = halfvec_kmeans_accum,
+	STYPE = internal,
+	FINALFUNC = halfvec_kmeans_final,
+	COMBINEFUNC = vector_kmeans_combine,
+	SERIALFUNC = vector_kmeans_serial,
+	DESERIALFUNC = vector_kmeans_deserial,
+	PARALLEL = SAFE
+);
+
+CREATE AGGREGATE vector_kmeans(halfvec, integer, integer) (
+	SFUNC = halfvec_kmeans_accum,
+	STYPE = internal,
+	FINALFUNC = halfvec_kmeans_final,
+	COMBINEFUNC = vector_kmeans_combine,
+	SERIALFUNC = vector_kmeans_serial,
+	DESERIALFUNC = vector_kmeans_deserial,
+	PARALLEL = SAFE
+);
+
+-- exact search functions
+
+CREATE FUNCTION vector_exact_knn(tbl regclass, col name, queries vector[], k integer, metric text DEFAULT 'l2')
+	RETURNS TABLE (query integer, ctid tid, distance float8)
+	AS 'MODULE_PATHNAME' LANGUAGE C STABLE STRICT PARALLEL SAFE;
+
+-- join functions
+
+CREATE FUNCTION vector_knn_join(queries regclass, col name, index regclass, k int)
+RETURNS TABLE (query_ctid tid, ctid tid, distance float8) AS $$
+DECLARE
+	tbl regclass;
+	expr text;
+	am name;
+	op text;
+	nsp name;
+	typ name;
+	clusters int;
+	num_rows float8;
+	sample_sql text := '';
+	centers_sql text := '';
+	cluster_sql text := 'NULL::int';
+BEGIN
+	IF k < 1 THEN
+		RAISE EXCEPTION 'k must be greater than zero';
+	END IF;
+
+	-- the extension may not be on the search path
+	EXECUTE format('SELECT * FROM %s.vector_index_info($1)', (SELECT extnamespace::regnamespace FROM pg_extension WHERE extname = 'vector'))
+		INTO tbl, expr, am, op, nsp USING index;
+
+	IF op IS NULL THEN
+		RAISE EXCEPTION 'index must support ordering by distance';
+	END IF;
+
+	SELECT t.typname INTO typ
+	FROM pg_attribute a
+	INNER JOIN pg_type t ON t.oid = a.atttypid
+	WHERE a.attrelid = queries AND a.attname = col AND NOT a.attisdropped;
+
+	IF typ IS NULL THEN
+		RAISE EXCEPTION 'column "%" does not exist', col;
+	END IF;
+
+	-- search in order of the nearest cluster so consecutive searches visit the same pages
+	IF typ IN ('vector', 'halfvec') THEN
+		SELECT least(greatest(sqrt(greatest(reltuples, 0)), 1), 256)::int, reltuples INTO clusters, num_rows FROM pg_class WHERE oid = queries;
+
+		-- cluster a sample of about 20 rows per cluster to stay within maintenance_work_mem
+		IF num_rows > 20 * clusters THEN
+			sample_sql := format(' TABLESAMPLE BERNOULLI (%s)', 100.0 * 20 * clusters / num_rows);
+		END IF;
+
+		centers_sql := format(', (SELECT %I.vector_kmeans(%I, %s) AS centers FROM %s%s) c', nsp, col, clusters, queries, sample_sql);
+		cluster_sql := format('(SELECT i FROM generate_subscripts(c.centers, 1) i ORDER BY a.%I %s c.centers[i] LIMIT 1)', col, op);
+	END IF;
+
+	RETURN QUERY EXECUTE format('SELECT q.ctid, n.ctid, n.distance FROM (SELECT a.ctid, a.%I AS v FROM %s a%s WHERE a.%I IS NOT NULL ORDER BY %s) q CROSS JOIN LATERAL (SELECT b.ctid, (%s) %s q.v AS distance FROM %s b ORDER BY (%s) %s q.v LIMIT %s) n',
+		col, queries, centers_sql, col, cluster_sql, expr, op, tbl, expr, op, k);
+END;
+$$ LANGUAGE plpgsql;
+
+-- duplicate functions
+
+CREATE FUNCTION vector_near_duplicates(index regclass, epsilon float8)
+	RETURNS TABLE (ctid1 tid, ctid2 tid, distance float8)
+	AS 'MODULE_PATHNAME' LANGUAGE C STABLE STRICT PARALLEL SAFE;
+
+-- rerank functions
+
+CREATE FUNCTION vector_binary_quantize_arg(regclass) RETURNS text
+	AS 'MODULE_PATHNAME' LANGUAGE C STABLE STRICT;
+
+CREATE FUNCTION vector_rerank_search(index regclass, query anyelement, k int, rerank_factor int DEFAULT 4, metric text DEFAULT 'l2')
+RETURNS TABLE (ctid tid, distance float8) AS $$
+DECLARE
+	tbl regclass;
+	expr text;
+	am name;
+	nsp name;
+	col text;
+	op text;
+	bitop text;
+	candidates int;
+	ef_search text;
+BEGIN
+	IF k < 1 THEN
+		RAISE EXCEPTION 'k must be greater than zero';
+	END IF;
+
+	IF rerank_factor < 1 THEN
+		RAISE EXCEPTION 'rerank_factor must be greater than zero';
+	END IF;
+
+	op := CASE metric WHEN 'l2' THEN '<->' WHEN 'ip' THEN '<#>' WHEN 'cosine' THEN '<=>' WHEN 'l1' THEN '<+>' END;
+	IF op IS NULL THEN
+		RAISE EXCEPTION 'metric must be l2, ip, cosine, or l1';
+	END IF;
+
+	-- the extension may not be on the search path
+	EXECUTE format('SELECT * FROM %s.vector_index_info($1)', (SELECT extnamespace::regnamespace FROM pg_extension WHERE extname = 'vector'))
+		INTO tbl, expr, am, bitop, nsp USING index;
+
+	-- the index must be on the binary quantization of the column
+	IF bitop IS NOT NULL THEN
+		EXECUTE format('SELECT %s.vector_binary_quantize_arg($1)', (SELECT extnamespace::regnamespace FROM pg_extension WHERE extname = 'vector'))
+			INTO col USING index;
+	END IF;
+
+	IF col IS NULL THEN
+		RAISE EXCEPTION 'index must be on binary_quantize';
+	END IF;
+
+	op := format('OPERATOR(%I.%s)', nsp, op);
+	candidates := k * rerank_factor;
+
+	-- the graph must return enough candidates for the rerank
+	IF am = 'hnsw' AND candidates > current_setting('hnsw.ef_search')::int THEN
+		ef_search := current_setting('hnsw.ef_search');
+		PERFORM set_config('hnsw.ef_search', least(candidates, 1000)::text, true);
+	END IF;
+
+	RETURN QUERY EXECUTE format('SELECT c.ctid, (c.v %s $1)::float8 FROM (SELECT t.ctid, %s AS v FROM %s t ORDER BY %s %s %I.binary_quantize($1) LIMIT %s) c ORDER BY 2, 1 LIMIT %s',
+		op, col, tbl, expr, bitop, nsp, candidates, k) USING query;
+
+	IF ef_search IS NOT NULL THEN
+		PERFORM set_config('hnsw.ef_search', ef_search, true);
+	END IF;
+END;
+$$ LANGUAGE plpgsql;
+
+-- hybrid functions
+
+CREATE FUNCTION vector_hybrid_search(index regclass, query anyelement, sparse_col name, sparse_query sparsevec, k int, dense_weight float8 DEFAULT 0.5, candidate_factor int DEFAULT 4)
+RETURNS TABLE (ctid tid, score float8) AS $$
+DECLARE
+	tbl regclass;
+	expr text;
+	am name;
+	op text;
+	nsp name;
+	candidates int;
+	ef_search text;
+BEGIN
+	IF k < 1 THEN
+		RAISE EXCEPTION 'k must be greater than zero';
+	END IF;
+
+	IF candidate_factor < 1 THEN
+		RAISE EXCEPTION 'candidate_factor must be greater than zero';
+	END IF;
+
+	IF NOT dense_weight BETWEEN 0 AND 1 THEN
+		RAISE EXCEPTION 'dense_weight must be between 0 and 1';
+	END IF;
+
+	-- the extension may not be on the search path
+	EXECUTE format('SELECT * FROM %s.vector_index_info($1)', (SELECT extnamespace::regnamespace FROM pg_extension WHERE extname = 'vector'))
+		INTO tbl, expr, am, op, nsp USING index;
+
+	IF op IS NULL THEN
+		RAISE EXCEPTION 'index must support ordering by distance';
+	END IF;
+
+	candidates := k * candidate_factor;
+
+	-- the graph must return enough candidates for the sparse scores
+	IF am = 'hnsw' AND candidates > current_setting('hnsw.ef_search')::int THEN
+		ef_search := current_setting('hnsw.ef_search');
+		PERFORM set_config('hnsw.ef_search', least(candidates, 1000)::text, true);
+	END IF;
+
+	-- score sparse vectors on the rows fetched by the dense search
+	RETURN QUERY EXECUTE format('SELECT c.ctid, ($3 * c.d + (1 - $3) * coalesce(c.s OPERATOR(%I.<#>) $2, 0))::float8 FROM (SELECT t.ctid, (%s) %s $1 AS d, t.%I AS s FROM %s t ORDER BY (%s) %s $1 LIMIT %s) c ORDER BY 2, 1 LIMIT %s',
+		nsp, expr, op, sparse_col, tbl, expr, op, candidates, k) USING query, sparse_query, dense_weight;
+
+	IF ef_search IS NOT NULL THEN
+		PERFORM set_config('hnsw.ef_search', ef_search, true);
+	END IF;
+END;
+$$ LANGUAGE plpgsql;
+
+-- late interaction functions
+
+CREATE FUNCTION max_sim(vector[], vector[]) RETURNS float8
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+-- bf16vec type
+
+CREATE TYPE bf16vec;
+
+CREATE FUNCTION bf16vec_in(cstring, oid, integer) RETURNS bf16vec
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION bf16vec_out(bf16vec) RETURNS cstring
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION bf16vec_typmod_in(cstring[]) RETURNS integer
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION bf16vec_recv(internal, oid, integer) RETURNS bf16vec
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION bf16vec_send(bf16vec) RETURNS bytea
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE TYPE bf16vec (
+	INPUT     = bf16vec_in,
+	OUTPUT    = bf16vec_out,
+	TYPMOD_IN = bf16vec_typmod_in,
+	RECEIVE   = bf16vec_recv,
+	SEND      = bf16vec_send,
+	STORAGE   = external
+);
+
+-- bf16vec functions
+
+CREATE FUNCTION l2_distance(bf16vec, bf16vec) RETURNS float8
+	AS 'MODULE_PATHNAME', 'bf16vec_l2_distance' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION inner_product(bf16vec, bf16vec) RETURNS float8
+	AS 'MODULE_PATHNAME', 'bf16vec_inner_product' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION cosine_distance(bf16vec, bf16vec) RETURNS float8
+	AS 'MODULE_PATHNAME', 'bf16vec_cosine_distance' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION l1_distance(bf16vec, bf16vec) RETURNS float8
+	AS 'MODULE_PATHNAME', 'bf16vec_l1_distance' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION vector_dims(bf16vec) RETURNS integer
+	AS 'MODULE_PATHNAME', 'bf16vec_vector_dims' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION l2_norm(bf16vec) RETURNS float8
+	AS 'MODULE_PATHNAME', 'bf16vec_l2_norm' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION l2_normalize(bf16vec) RETURNS bf16vec
+	AS 'MODULE_PATHNAME', 'bf16vec_l2_normalize' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+-- bf16vec private functions
+
+CREATE FUNCTION bf16vec_lt(bf16vec, bf16vec) RETURNS bool
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION bf16vec_le(bf16vec, bf16vec) RETURNS bool
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION bf16vec_eq(bf16vec, bf16vec) RETURNS bool
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION bf16vec_ne(bf16vec, bf16vec) RETURNS bool
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION bf16vec_ge(bf16vec, bf16vec) RETURNS bool
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION bf16vec_gt(bf16vec, bf16vec) RETURNS bool
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION bf16vec_cmp(bf16vec, bf16vec) RETURNS int4
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION bf16vec_l2_squared_distance(bf16vec, bf16vec) RETURNS float8
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION bf16vec_negative_inner_product(bf16vec, bf16vec) RETURNS float8
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION bf16vec_spherical_distance(bf16vec, bf16vec) RETURNS float8
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+-- bf16vec cast functions
+
+CREATE FUNCTION bf16vec(bf16vec, integer, boolean) RETURNS bf16vec
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION bf16vec_to_vector(bf16vec, integer, boolean) RETURNS vector
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION vector_to_bf16vec(vector, integer, boolean) RETURNS bf16vec
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION bf16vec_to_halfvec(bf16vec, integer, boolean) RETURNS halfvec
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION halfvec_to_bf16vec(halfvec, integer, boolean) RETURNS bf16vec
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION array_to_bf16vec(integer[], integer, boolean) RETURNS bf16vec
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION array_to_bf16vec(real[], integer, boolean) RETURNS bf16vec
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION array_to_bf16vec(double precision[], integer, boolean) RETURNS bf16vec
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION array_to_bf16vec(numeric[], integer, boolean) RETURNS bf16vec
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION bf16vec_to_float4(bf16vec, integer, boolean) RETURNS real[]
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+-- bf16vec casts
+
+CREATE CAST (bf16vec AS bf16vec)
+	WITH FUNCTION bf16vec(bf16vec, integer, boolean) AS IMPLICIT;
+
+CREATE CAST (bf16vec AS vector)
+	WITH FUNCTION bf16vec_to_vector(bf16vec, integer, boolean) AS ASSIGNMENT;
+
+CREATE CAST (vector AS bf16vec)
+	WITH FUNCTION vector_to_bf16vec(vector, integer, boolean) AS ASSIGNMENT;
+
+CREATE CAST (bf16vec AS halfvec)
+	WITH FUNCTION bf16vec_to_halfvec(bf16vec, integer, boolean) AS ASSIGNMENT;
+
+CREATE CAST (halfvec AS bf16vec)
+	WITH FUNCTION halfvec_to_bf16vec(halfvec, integer, boolean) AS ASSIGNMENT;
+
+CREATE CAST (bf16vec AS real[])
+	WITH FUNCTION bf16vec_to_float4(bf16vec, integer, boolean) AS ASSIGNMENT;
+
+CREATE CAST (integer[] AS bf16vec)
+	WITH FUNCTION array_to_bf16vec(integer[], integer, boolean) AS ASSIGNMENT;
+
+CREATE CAST (real[] AS bf16vec)
+	WITH FUNCTION array_to_bf16vec(real[], integer, boolean) AS ASSIGNMENT;
+
+CREATE CAST (double precision[] AS bf16vec)
+	WITH FUNCTION array_to_bf16vec(double precision[], integer, boolean) AS ASSIGNMENT;
+
+CREATE CAST (numeric[] AS bf16vec)
+	WITH FUNCTION array_to_bf16vec(numeric[], integer, boolean) AS ASSIGNMENT;
+
+-- bf16vec operators
+
+CREATE OPERATOR <-> (
+	LEFTARG = bf16vec, RIGHTARG = bf16vec, PROCEDURE = l2_distance,
+	COMMUTATOR = '<->'
+);
+
+CREATE OPERATOR <#> (
+	LEFTARG = bf16vec, RIGHTARG = bf16vec, PROCEDURE = bf16vec_negative_inner_product,
+	COMMUTATOR = '<#>'
+);
+
+CREATE OPERATOR <=> (
+	LEFTARG = bf16vec, RIGHTARG = bf16vec, PROCEDURE = cosine_distance,
+	COMMUTATOR = '<=>'
+);
+
+CREATE OPERATOR <+> (
+	LEFTARG = bf16vec, RIGHTARG = bf16vec, PROCEDURE = l1_distance,
+	COMMUTATOR = '<+>'
+);
+
+CREATE OPERATOR < (
+	LEFTARG = bf16vec, RIGHTARG = bf16vec, PROCEDURE = bf16vec_lt,
+	COMMUTATOR = > , NEGATOR = >= ,
+	RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+);
+
+CREATE OPERATOR <= (
+	LEFTARG = bf16vec, RIGHTARG = bf16vec, PROCEDURE = bf16vec_le,
+	COMMUTATOR = >= , NEGATOR = > ,
+	RESTRICT = scalarlesel, JOIN = scalarlejoinsel
+);
+
+CREATE OPERATOR = (
+	LEFTARG = bf16vec, RIGHTARG = bf16vec, PROCEDURE = bf16vec_eq,
+	COMMUTATOR = = , NEGATOR = <> ,
+	RESTRICT = eqsel, JOIN = eqjoinsel
+);
+
+CREATE OPERATOR <> (
+	LEFTARG = bf16vec, RIGHTARG = bf16vec, PROCEDURE = bf16vec_ne,
+	COMMUTATOR = <> , NEGATOR = = ,
+	RESTRICT = eqsel, JOIN = eqjoinsel
+);
+
+CREATE OPERATOR >= (
+	LEFTARG = bf16vec, RIGHTARG = bf16vec, PROCEDURE = bf16vec_ge,
+	COMMUTATOR = <= , NEGATOR = < ,
+	RESTRICT = scalargesel, JOIN = scalargejoinsel
+);
+
+CREATE OPERATOR > (
+	LEFTARG = bf16vec, RIGHTARG = bf16vec, PROCEDURE = bf16vec_gt,
+	COMMUTATOR = < , NEGATOR = <= ,
+	RESTRICT = scalargtsel, JOIN = scalargtjoinsel
+);
+
+-- bf16vec access method private functions
+
+CREATE FUNCTION ivfflat_bf16vec_support(internal) RETURNS internal
+	AS 'MODULE_PATHNAME' LANGUAGE C;
+
+CREATE FUNCTION hnsw_bf16vec_support(internal) RETURNS internal
+	AS 'MODULE_PATHNAME' LANGUAGE C;
+
+-- bf16vec opclasses
+
+CREATE OPERATOR CLASS bf16vec_ops
+	DEFAULT FOR TYPE bf16vec USING btree AS
+	OPERATOR 1 < ,
+	OPERATOR 2 <= ,
+	OPERATOR 3 = ,
+	OPERATOR 4 >= ,
+	OPERATOR 5 > ,
+	FUNCTION 1 bf16vec_cmp(bf16vec, bf16vec);
+
+CREATE OPERATOR CLASS bf16vec_l2_ops
+	FOR TYPE bf16vec USING ivfflat AS
+	OPERATOR 1 <-> (bf16vec, bf16vec) FOR ORDER BY float_ops,
+	FUNCTION 1 bf16vec_l2_squared_distance(bf16vec, bf16vec),
+	FUNCTION 3 l2_distance(bf16vec, bf16vec),
+	FUNCTION 5 ivfflat_bf16vec_support(internal);
+
+CREATE OPERATOR CLASS bf16vec_ip_ops
+	FOR TYPE bf16vec USING ivfflat AS
+	OPERATOR 1 <#> (bf16vec, bf16vec) FOR ORDER BY float_ops,
+	FUNCTION 1 bf16vec_negative_inner_product(bf16vec, bf16vec),
+	FUNCTION 3 bf16vec_spherical_distance(bf16vec, bf16vec),
+	FUNCTION 4 l2_norm(bf16vec),
+	FUNCTION 5 ivfflat_bf16vec_support(internal);
+
+CREATE OPERATOR CLASS bf16vec_cosine_ops
+	FOR TYPE bf16vec USING ivfflat AS
+	OPERATOR 1 <=> (bf16vec, bf16vec) FOR ORDER BY float_ops,
+	FUNCTION 1 bf16vec_negative_inner_product(bf16vec, bf16vec),
+	FUNCTION 2 l2_norm(bf16vec),
+	FUNCTION 3 bf16vec_spherical_distance(bf16vec, bf16vec),
+	FUNCTION 4 l2_norm(bf16vec),
+	FUNCTION 5 ivfflat_bf16vec_support(internal);
+
+CREATE OPERATOR CLASS bf16vec_l2_ops
+	FOR TYPE bf16vec USING hnsw AS
+	OPERATOR 1 <-> (bf16vec, bf16vec) FOR ORDER BY float_ops,
+	FUNCTION 1 bf16vec_l2_squared_distance(bf16vec, bf16vec),
+	FUNCTION 3 hnsw_bf16vec_support(internal);
+
+CREATE OPERATOR CLASS bf16vec_ip_ops
+	FOR TYPE bf16vec USING hnsw AS
+	OPERATOR 1 <#> (bf16vec, bf16vec) FOR ORDER BY float_ops,
+	FUNCTION 1 bf16vec_negative_inner_product(bf16vec, bf16vec),
+	FUNCTION 3 hnsw_bf16vec_support(internal);
+
+CREATE OPERATOR CLASS bf16vec_cosine_ops
+	FOR TYPE bf16vec USING hnsw AS
+	OPERATOR 1 <=> (bf16vec, bf16vec) FOR ORDER BY float_ops,
+	FUNCTION 1 bf16vec_negative_inner_product(bf16vec, bf16vec),
+	FUNCTION 2 l2_norm(bf16vec),
+	FUNCTION 3 hnsw_bf16vec_support(internal);
+
+CREATE OPERATOR CLASS bf16vec_l1_ops
+	FOR TYPE bf16vec USING hnsw AS
+	OPERATOR 1 <+> (bf16vec, bf16vec) FOR ORDER BY float_ops,
+	FUNCTION 1 l1_distance(bf16vec, bf16vec),
+	FUNCTION 3 hnsw_bf16vec_support(internal);
+
+-- int8vec type
+
+CREATE TYPE int8vec;
+
+CREATE FUNCTION int8vec_in(cstring, oid, integer) RETURNS int8vec
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION int8vec_out(int8vec) RETURNS cstring
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION int8vec_typmod_in(cstring[]) RETURNS integer
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION int8vec_recv(internal, oid, integer) RETURNS int8vec
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION int8vec_send(int8vec) RETURNS bytea
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE TYPE int8vec (
+	INPUT     = int8vec_in,
+	OUTPUT    = int8vec_out,
+	TYPMOD_IN = int8vec_typmod_in,
+	RECEIVE   = int8vec_recv,
+	SEND      = int8vec_send,
+	STORAGE   = external
+);
+
+-- int8vec functions
+
+CREATE FUNCTION l2_distance(int8vec, int8vec) RETURNS float8
+	AS 'MODULE_PATHNAME', 'int8vec_l2_distance' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION inner_product(int8vec, int8vec) RETURNS float8
+	AS 'MODULE_PATHNAME', 'int8vec_inner_product' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION cosine_distance(int8vec, int8vec) RETURNS float8
+	AS 'MODULE_PATHNAME', 'int8vec_cosine_distance' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION l1_distance(int8vec, int8vec) RETURNS float8
+	AS 'MODULE_PATHNAME', 'int8vec_l1_distance' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION vector_dims(int8vec) RETURNS integer
+	AS 'MODULE_PATHNAME', 'int8vec_vector_dims' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION l2_norm(int8vec) RETURNS float8
+	AS 'MODULE_PATHNAME', 'int8vec_l2_norm' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+-- int8vec private functions
+
+CREATE FUNCTION int8vec_lt(int8vec, int8vec) RETURNS bool
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION int8vec_le(int8vec, int8vec) RETURNS bool
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION int8vec_eq(int8vec, int8vec) RETURNS bool
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION int8vec_ne(int8vec, int8vec) RETURNS bool
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION int8vec_ge(int8vec, int8vec) RETURNS bool
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION int8vec_gt(int8vec, int8vec) RETURNS bool
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION int8vec_cmp(int8vec, int8vec) RETURNS int4
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION int8vec_l2_squared_distance(int8vec, int8vec) RETURNS float8
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION int8vec_negative_inner_product(int8vec, int8vec) RETURNS float8
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+-- int8vec cast functions
+
+CREATE FUNCTION int8vec(int8vec, integer, boolean) RETURNS int8vec
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION int8vec_to_vector(int8vec, integer, boolean) RETURNS vector
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION vector_to_int8vec(vector, integer, boolean) RETURNS int8vec
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION array_to_int8vec(integer[], integer, boolean) RETURNS int8vec
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION int8vec_to_int4(int8vec, integer, boolean) RETURNS integer[]
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+-- int8vec casts
+
+CREATE CAST (int8vec AS int8vec)
+	WITH FUNCTION int8vec(int8vec, integer, boolean) AS IMPLICIT;
+
+CREATE CAST (int8vec AS vector)
+	WITH FUNCTION int8vec_to_vector(int8vec, integer, boolean) AS ASSIGNMENT;
+
+CREATE CAST (vector AS int8vec)
+	WITH FUNCTION vector_to_int8vec(vector, integer, boolean) AS ASSIGNMENT;
+
+CREATE CAST (int8vec AS integer[])
+	WITH FUNCTION int8vec_to_int4(int8vec, integer, boolean) AS ASSIGNMENT;
+
+CREATE CAST (integer[] AS int8vec)
+	WITH FUNCTION array_to_int8vec(integer[], integer, boolean) AS ASSIGNMENT;
+
+-- int8vec operators
+
+CREATE OPERATOR <-> (
+	LEFTARG = int8vec, RIGHTARG = int8vec, PROCEDURE = l2_distance,
+	COMMUTATOR = '<->'
+);
+
+CREATE OPERATOR <#> (
+	LEFTARG = int8vec, RIGHTARG = int8vec, PROCEDURE = int8vec_negative_inner_product,
+	COMMUTATOR = '<#>'
+);
+
+CREATE OPERATOR <=> (
+	LEFTARG = int8vec, RIGHTARG = int8vec, PROCEDURE = cosine_distance,
+	COMMUTATOR = '<=>'
+);
+
+CREATE OPERATOR <+> (
+	LEFTARG = int8vec, RIGHTARG = int8vec, PROCEDURE = l1_distance,
+	COMMUTATOR = '<+>'
+);
+
+CREATE OPERATOR < (
+	LEFTARG = int8vec, RIGHTARG = int8vec, PROCEDURE = int8vec_lt,
+	COMMUTATOR = > , NEGATOR = >= ,
+	RESTRICT = scalarltsel, JOIN = scalarltjoinsel
+);
+
+CREATE OPERATOR <= (
+	LEFTARG = int8vec, RIGHTARG = int8vec, PROCEDURE = int8vec_le,
+	COMMUTATOR = >= , NEGATOR = > ,
+	RESTRICT = scalarlesel, JOIN = scalarlejoinsel
+);
+
+CREATE OPERATOR = (
+	LEFTARG = int8vec, RIGHTARG = int8vec, PROCEDURE = int8vec_eq,
+	COMMUTATOR = = , NEGATOR = <> ,
+	RESTRICT = eqsel, JOIN = eqjoinsel
+);
+
+CREATE OPERATOR <> (
+	LEFTARG = int8vec, RIGHTARG = int8vec, PROCEDURE = int8vec_ne,
+	COMMUTATOR = <> , NEGATOR = = ,
+	RESTRICT = eqsel, JOIN = eqjoinsel
+);
+
+CREATE OPERATOR >= (
+	LEFTARG = int8vec, RIGHTARG = int8vec, PROCEDURE = int8vec_ge,
+	COMMUTATOR = <= , NEGATOR = < ,
+	RESTRICT = scalargesel, JOIN = scalargejoinsel
+);
+
+CREATE OPERATOR > (
+	LEFTARG = int8vec, RIGHTARG = int8vec, PROCEDURE = int8vec_gt,
+	COMMUTATOR = < , NEGATOR = <= ,
+	RESTRICT = scalargtsel, JOIN = scalargtjoinsel
+);
+
+-- int8vec access method private functions
+
+CREATE FUNCTION ivfflat_int8vec_support(internal) RETURNS internal
+	AS 'MODULE_PATHNAME' LANGUAGE C;
+
+CREATE FUNCTION hnsw_int8vec_support(internal) RETURNS internal
+	AS 'MODULE_PATHNAME' LANGUAGE C;
+
+-- int8vec opclasses
+
+CREATE OPERATOR CLASS int8vec_ops
+	DEFAULT FOR TYPE int8vec USING btree AS
+	OPERATOR 1 < ,
+	OPERATOR 2 <= ,
+	OPERATOR 3 = ,
+	OPERATOR 4 >= ,
+	OPERATOR 5 > ,
+	FUNCTION 1 int8vec_cmp(int8vec, int8vec);
+
+CREATE OPERATOR CLASS int8vec_l2_ops
+	FOR TYPE int8vec USING ivfflat AS
+	OPERATOR 1 <-> (int8vec, int8vec) FOR ORDER BY float_ops,
+	FUNCTION 1 int8vec_l2_squared_distance(int8vec, int8vec),
+	FUNCTION 3 l2_distance(int8vec, int8vec),
+	FUNCTION 5 ivfflat_int8vec_support(internal);
+
+CREATE OPERATOR CLASS int8vec_ip_ops
+	FOR TYPE int8vec USING ivfflat AS
+	OPERATOR 1 <#> (int8vec, int8vec) FOR ORDER BY float_ops,
+	FUNCTION 1 int8vec_negative_inner_product(int8vec, int8vec),
+	FUNCTION 3 l2_distance(int8vec, int8vec),
+	FUNCTION 5 ivfflat_int8vec_support(internal);
+
+CREATE OPERATOR CLASS int8vec_l2_ops
+	FOR TYPE int8vec USING hnsw AS
+	OPERATOR 1 <-> (int8vec, int8vec) FOR ORDER BY float_ops,
+	FUNCTION 1 int8vec_l2_squared_distance(int8vec, int8vec),
+	FUNCTION 3 hnsw_int8vec_support(internal);
+
+CREATE OPERATOR CLASS int8vec_ip_ops
+	FOR TYPE int8vec USING hnsw AS
+	OPERATOR 1 <#> (int8vec, int8vec) FOR ORDER BY float_ops,
+	FUNCTION 1 int8vec_negative_inner_product(int8vec, int8vec),
+	FUNCTION 3 hnsw_int8vec_support(internal);
+
+CREATE OPERATOR CLASS int8vec_l1_ops
+	FOR TYPE int8vec USING hnsw AS
+	OPERATOR 1 <+> (int8vec, int8vec) FOR ORDER BY float_ops,
+	FUNCTION 1 l1_distance(int8vec, int8vec),
+	FUNCTION 3 hnsw_int8vec_support(internal);
+
+-- statistics functions
+
+CREATE FUNCTION vector_typanalyze(internal) RETURNS bool
+	AS 'MODULE_PATHNAME' LANGUAGE C STRICT;
+
+ALTER TYPE vector SET (ANALYZE = vector_typanalyze);
+ALTER TYPE halfvec SET (ANALYZE = vector_typanalyze);
+ALTER TYPE sparsevec SET (ANALYZE = vector_typanalyze);
+
+CREATE FUNCTION vector_within_support(internal) RETURNS internal
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION halfvec_within_support(internal) RETURNS internal
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION sparsevec_within_support(internal) RETURNS internal
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE;
+
+CREATE FUNCTION l2_within(vector, vector, float8) RETURNS bool
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE SUPPORT vector_within_support;
+
+CREATE FUNCTION cosine_within(vector, vector, float8) RETURNS bool
+	AS 'MODULE_PATHNAME' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE SUPPORT vector_within_support;
+
+CREATE FUNCTION l2_within(halfvec, halfvec, float8) RETURNS bool
+	AS 'MODULE_PATHNAME', 'halfvec_l2_within' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE SUPPORT halfvec_within_support;
+
+CREATE FUNCTION cosine_within(halfvec, halfvec, float8) RETURNS bool
+	AS 'MODULE_PATHNAME', 'halfvec_cosine_within' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE SUPPORT halfvec_within_support;
+
+CREATE FUNCTION l2_within(sparsevec, sparsevec, float8) RETURNS bool
+	AS 'MODULE_PATHNAME', 'sparsevec_l2_within' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE SUPPORT sparsevec_within_support;
+
+CREATE FUNCTION cosine_within(sparsevec, sparsevec, float8) RETURNS bool
+	AS 'MODULE_PATHNAME', 'sparsevec_cosine_within' LANGUAGE C IMMUTABLE STRICT PARALLEL SAFE SUPPORT sparsevec_within_support;
@@ -0,0 +1,409 @@
+#include "postgres.h"
+
+#include "bf16utils.h"
+#include "bf16vec.h"
+
+#ifdef BF16VEC_DISPATCH
+#include <immintrin.h>
+
+#if defined(USE__GET_CPUID)
+#include <cpuid.h>
+#else
+#include <intrin.h>
+#endif
+
+#ifdef _MSC_VER
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2,fma")))
+#endif
+
+/* Requires compiler support for the intrinsics */
+#if defined(USE__GET_CPUID) && ((defined(__clang_major__) && __clang_major__ >= 9) || (!defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 10))
+#define BF16VEC_AVX512_BF16
+#define TARGET_AVX512_BF16 __attribute__((target("avx512f,avx512bf16")))
+#endif
+#endif
+
+float		(*Bf16vecL2SquaredDistance) (int dim, bf16 * ax, bf16 * bx);
+float		(*Bf16vecInnerProduct) (int dim, bf16 * ax, bf16 * bx);
+double		(*Bf16vecCosineSimilarity) (int dim, bf16 * ax, bf16 * bx);
+float		(*Bf16vecL1Distance) (int dim, bf16 * ax, bf16 * bx);
+
+#ifdef BF16VEC_DISPATCH
+/*
+ * Convert 8 bf16 values to float4 by shifting into the upper bits
+ */
+TARGET_AVX2 static inline __m256
+Bf16x8ToFloat4(bf16 * x)
+{
+	__m128i		xi = _mm_loadu_si128((__m128i *) x);
+
+	return _mm256_castsi256_ps(_mm256_slli_epi32(_mm256_cvtepu16_epi32(xi), 16));
+}
+
+TARGET_AVX2 static inline float
+SumFloat4x8(__m256 v)
+{
+	float		s[8];
+
+	_mm256_storeu_ps(s, v);
+	return s[0] + s[1] + s[2] + s[3] + s[4] + s[5] + s[6] + s[7];
+}
+#endif
+
+static float
+Bf16vecL2SquaredDistanceDefault(int dim, bf16 * ax, bf16 * bx)
+{
+	float		distance = 0.0;
+
+	/* Auto-vectorized */
+	for (int i = 0; i < dim; i++)
+	{
+		float		diff = Bf16ToFloat4(ax[i]) - Bf16ToFloat4(bx[i]);
+
+		distance += diff * diff;
+	}
+
+	return distance;
+}
+
+#ifdef BF16VEC_DISPATCH
+TARGET_AVX2 static float
+Bf16vecL2SquaredDistanceAvx2(int dim, bf16 * ax, bf16 * bx)
+{
+	float		distance;
+	int			i;
+	int			count = (dim / 8) * 8;
+	__m256		dist = _mm256_setzero_ps();
+
+	for (i = 0; i < count; i += 8)
+	{
+		__m256		diff = _mm256_sub_ps(Bf16x8ToFloat4(ax + i), Bf16x8ToFloat4(bx + i));
+
+		dist = _mm256_fmadd_ps(diff, diff, dist);
+	}
+
+	distance = SumFloat4x8(dist);
+
+	for (; i < dim; i++)
+	{
+		float		diff = Bf16ToFloat4(ax[i]) - Bf16ToFloat4(bx[i]);
+
+		distance += diff * diff;
+	}
+
+	return distance;
+}
+#endif
+
+static float
+Bf16vecInnerProductDefault(int dim, bf16 * ax, bf16 * bx)
+{
+	float		distance = 0.0;
+
+	/* Auto-vectorized */
+	for (int i = 0; i < dim; i++)
+		distance += Bf16ToFloat4(ax[i]) * Bf16ToFloat4(bx[i]);
+
+	return distance;
+}
+
+#ifdef BF16VEC_DISPATCH
+TARGET_AVX2 static float
+Bf16vecInnerProductAvx2(int dim, bf16 * ax, bf16 * bx)
+{
+	float		distance;
+	int			i;
+	int			count = (dim / 8) * 8;
+	__m256		dist = _mm256_setzero_ps();
+
+	for (i = 0; i < count; i += 8)
+		dist = _mm256_fmadd_ps(Bf16x8ToFloat4(ax + i), Bf16x8ToFloat4(bx + i), dist);
+
+	distance = SumFloat4x8(dist);
+
+	for (; i < dim; i++)
+		distance += Bf16ToFloat4(ax[i]) * Bf16ToFloat4(bx[i]);
+
+	return distance;
+}
+#endif
+
+#ifdef BF16VEC_AVX512_BF16
+TARGET_AVX512_BF16 static float
+Bf16vecInnerProductAvx512Bf16(int dim, bf16 * ax, bf16 * bx)
+{
+	float		distance;
+	int			i;
+	int			count = (dim / 32) * 32;
+	__m512		dist = _mm512_setzero_ps();
+
+	/* Multiplies pairs and accumulates in float4 */
+	for (i = 0; i < count; i += 32)
+	{
+		__m512bh	axi = (__m512bh) _mm512_loadu_si512((void *) (ax + i));
+		__m512bh	bxi = (__m512bh) _mm512_loadu_si512((void *) (bx + i));
+
+		dist = _mm512_dpbf16_ps(dist, axi, bxi);
+	}
+
+	distance = _mm512_reduce_add_ps(dist);
+
+	for (; i < dim; i++)
+		distance += Bf16ToFloat4(ax[i]) * Bf16ToFloat4(bx[i]);
+
+	return distance;
+}
+#endif
+
+static double
+Bf16vecCosineSimilarityDefault(int dim, bf16 * ax, bf16 * bx)
+{
+	float		similarity = 0.0;
+	float		norma = 0.0;
+	float		normb = 0.0;
+
+	/* Auto-vectorized */
+	for (int i = 0; i < dim; i++)
+	{
+		float		axi = Bf16ToFloat4(ax[i]);
+		float		bxi = Bf16ToFloat4(bx[i]);
+
+		similarity += axi * bxi;
+		norma += axi * axi;
+		normb += bxi * bxi;
+	}
+
+	/* Use sqrt(a * b) over sqrt(a) * sqrt(b) */
+	return (double) similarity / sqrt((double) norma * (double) normb);
+}
+
+#ifdef BF16VEC_DISPATCH
+TARGET_AVX2 static double
+Bf16vecCosineSimilarityAvx2(int dim, bf16 * ax, bf16 * bx)
+{
+	float		similarity;
+	float		norma;
+	float		normb;
+	int			i;
+	int			count = (dim / 8) * 8;
+	__m256		sim = _mm256_setzero_ps();
+	__m256		na = _mm256_setzero_ps();
+	__m256		nb = _mm256_setzero_ps();
+
+	for (i = 0; i < count; i += 8)
+	{
+		__m256		axs = Bf16x8ToFloat4(ax + i);
+		__m256		bxs = Bf16x8ToFloat4(bx + i);
+
+		sim = _mm256_fmadd_ps(axs, bxs, sim);
+		na = _mm256_fmadd_ps(axs, axs, na);
+		nb = _mm256_fmadd_ps(bxs, bxs, nb);
+	}
+
+	similarity = SumFloat4x8(sim);
+	norma = SumFloat4x8(na);
+	normb = SumFloat4x8(nb);
+
+	for (; i < dim; i++)
+	{
+		float		axi = Bf16ToFloat4(ax[i]);
+		float		bxi = Bf16ToFloat4(bx[i]);
+
+		similarity += axi * bxi;
+		norma += axi * axi;
+		normb += bxi * bxi;
+	}
+
+	/* Use sqrt(a * b) over sqrt(a) * sqrt(b) */
+	return (double) similarity / sqrt((double) norma * (double) normb);
+}
+#endif
+
+#ifdef BF16VEC_AVX512_BF16
+TARGET_AVX512_BF16 static double
+Bf16vecCosineSimilarityAvx512Bf16(int dim, bf16 * ax, bf16 * bx)
+{
+	float		similarity;
+	float		norma;
+	float		normb;
+	int			i;
+	int			count = (dim / 32) * 32;
+	__m512		sim = _mm512_setzero_ps();
+	__m512		na = _mm512_setzero_ps();
+	__m512		nb = _mm512_setzero_ps();
+
+	for (i = 0; i < count; i += 32)
+	{
+		__m512bh	axi = (__m512bh) _mm512_loadu_si512((void *) (ax + i));
+		__m512bh	bxi = (__m512bh) _mm512_loadu_si512((void *) (bx + i));
+
+		sim = _mm512_dpbf16_ps(sim, axi, bxi);
+		na = _mm512_dpbf16_ps(na, axi, axi);
+		nb = _mm512_dpbf16_ps(nb, bxi, bxi);
+	}
+
+	similarity = _mm512_reduce_add_ps(sim);
+	norma = _mm512_reduce_add_ps(na);
+	normb = _mm512_reduce_add_ps(nb);
+
+	for (; i < dim; i++)
+	{
+		float		axi = Bf16ToFloat4(ax[i]);
+		float		bxi = Bf16ToFloat4(bx[i]);
+
+		similarity += axi * bxi;
+		norma += axi * axi;
+		normb += bxi * bxi;
+	}
+
+	/* Use sqrt(a * b) over sqrt(a) * sqrt(b) */
+	return (double) similarity / sqrt((double) norma * (double) normb);
+}
+#endif
+
+static float
+Bf16vecL1DistanceDefault(int dim, bf16 * ax, bf16 * bx)
+{
+	float		distance = 0.0;
+
+	/* Auto-vectorized */
+	for (int i = 0; i < dim; i++)
+		distance += fabsf(Bf16ToFloat4(ax[i]) - Bf16ToFloat4(bx[i]));
+
+	return distance;
+}
+
+#ifdef BF16VEC_DISPATCH
+/* Does not require FMA, but keep logic simple */
+TARGET_AVX2 static float
+Bf16vecL1DistanceAvx2(int dim, bf16 * ax, bf16 * bx)
+{
+	float		distance;
+	int			i;
+	int			count = (dim / 8) * 8;
+	__m256		dist = _mm256_setzero_ps();
+	__m256		sign = _mm256_set1_ps(-0.0);
+
+	for (i = 0; i < count; i += 8)
+	{
+		__m256		diff = _mm256_sub_ps(Bf16x8ToFloat4(ax + i), Bf16x8ToFloat4(bx + i));
+
+		dist = _mm256_add_ps(dist, _mm256_andnot_ps(sign, diff));
+	}
+
+	distance = SumFloat4x8(dist);
+
+	for (; i < dim; i++)
+		distance += fabsf(Bf16ToFloat4(ax[i]) - Bf16ToFloat4(bx[i]));
+
+	return distance;
+}
+#endif
+
+#ifdef BF16VEC_DISPATCH
+#define CPU_FEATURE_FMA     (1 << 12)
+#define CPU_FEATURE_OSXSAVE (1 << 27)
+#define CPU_FEATURE_AVX     (1 << 28)
+
+#define CPU_FEATURE_AVX2     (1 << 5)
+#define CPU_FEATURE_AVX512F  (1 << 16)
+
+#define CPU_FEATURE_AVX512_BF16 (1 << 5)
+
+#ifdef _MSC_VER
+#define TARGET_XSAVE
+#else
+#define TARGET_XSAVE __attribute__((target("xsave")))
+#endif
+
+static void
+GetCpuid(unsigned int leaf, unsigned int subleaf, unsigned int *exx)
+{
+#if defined(USE__GET_CPUID)
+	__get_cpuid_count(leaf, subleaf, &exx[0], &exx[1], &exx[2], &exx[3]);
+#else
+	__cpuidex((int *) exx, leaf, subleaf);
+#endif
+}
+
+TARGET_XSAVE static bool
+SupportsAvx2(void)
+{
+	unsigned int exx[4] = {0, 0, 0, 0};
+	unsigned int features = CPU_FEATURE_OSXSAVE | CPU_FEATURE_AVX | CPU_FEATURE_FMA;
+
+	GetCpuid(1, 0, exx);
+
+	/* Check OS supports XSAVE */
+	if ((exx[2] & CPU_FEATURE_OSXSAVE) != CPU_FEATURE_OSXSAVE)
+		return false;
+
+	/* Check XMM and YMM registers are enabled */
+	if ((_xgetbv(0) & 6) != 6)
+		return false;
+
+	if ((exx[2] & features) != features)
+		return false;
+
+	GetCpuid(7, 0, exx);
+	return (exx[1] & CPU_FEATURE_AVX2) == CPU_FEATURE_AVX2;
+}
+
+#ifdef BF16VEC_AVX512_BF16
+TARGET_XSAVE static bool
+SupportsAvx512Bf16(void)
+{
+	unsigned int exx[4] = {0, 0, 0, 0};
+
+	/* Also checks OS supports XSAVE */
+	if (!SupportsAvx2())
+		return false;
+
+	/* Check opmask, ZMM_Hi256, and Hi16_ZMM registers are enabled */
+	if ((_xgetbv(0) & 0xE6) != 0xE6)
+		return false;
+
+	GetCpuid(7, 0, exx);
+	if ((exx[1] & CPU_FEATURE_AVX512F) != CPU_FEATURE_AVX512F)
+		return false;
+
+	/* Check max subleaf */
+	if (exx[0] < 1)
+		return false;
+
+	GetCpuid(7, 1, exx);
+	return (exx[0] & CPU_FEATURE_AVX512_BF16) == CPU_FEATURE_AVX512_BF16;
+}
+#endif
+#endif
+
+void
+Bf16vecInit(void)
+{
+	Bf16vecL2SquaredDistance = Bf16vecL2SquaredDistanceDefault;
+	Bf16vecInnerProduct = Bf16vecInnerProductDefault;
+	Bf16vecCosineSimilarity = Bf16vecCosineSimilarityDefault;
+	Bf16vecL1Distance = Bf16vecL1DistanceDefault;
+
+#ifdef BF16VEC_DISPATCH
+	if (SupportsAvx2())
+	{
+		Bf16vecL2SquaredDistance = Bf16vecL2SquaredDistanceAvx2;
+		Bf16vecInnerProduct = Bf16vecInnerProductAvx2;
+		Bf16vecCosineSimilarity = Bf16vecCosineSimilarityAvx2;
+		/* Does not require FMA, but keep logic simple */
+		Bf16vecL1Distance = Bf16vecL1DistanceAvx2;
+	}
+
+#ifdef BF16VEC_AVX512_BF16
+	/* No bf16 subtraction, so only products use the dot product instruction */
+	if (SupportsAvx512Bf16())
+	{
+		Bf16vecInnerProduct = Bf16vecInnerProductAvx512Bf16;
+		Bf16vecCosineSimilarity = Bf16vecCosineSimilarityAvx512Bf16;
+	}
+#endif
+#endif
+}
@@ -0,0 +1,104 @@
+#ifndef BF16UTILS_H
+#define BF16UTILS_H
+
+#include <math.h>
+
+#include "bf16vec.h"
+#include "common/shortest_dec.h"
+
+extern float (*Bf16vecL2SquaredDistance) (int dim, bf16 * ax, bf16 * bx);
+extern float (*Bf16vecInnerProduct) (int dim, bf16 * ax, bf16 * bx);
+extern double (*Bf16vecCosineSimilarity) (int dim, bf16 * ax, bf16 * bx);
+extern float (*Bf16vecL1Distance) (int dim, bf16 * ax, bf16 * bx);
+
+void		Bf16vecInit(void);
+
+/*
+ * Check if bf16 is NaN
+ */
+static inline bool
+Bf16IsNan(bf16 num)
+{
+	return (num & 0x7F80) == 0x7F80 && (num & 0x007F) != 0;
+}
+
+/*
+ * Check if bf16 is infinite
+ */
+static inline bool
+Bf16IsInf(bf16 num)
+{
+	return (num & 0x7FFF) == 0x7F80;
+}
+
+/*
+ * Check if bf16 is zero
+ */
+static inline bool
+Bf16IsZero(bf16 num)
+{
+	return (num & 0x7FFF) == 0x0000;
+}
+
+/*
+ * Convert a bf16 to a float4
+ */
+static inline float
+Bf16ToFloat4(bf16 num)
+{
+	union
+	{
+		float		f;
+		uint32		i;
+	}			swap;
+
+	swap.i = ((uint32) num) << 16;
+	return swap.f;
+}
+
+/*
+ * Convert a float4 to a bf16
+ */
+static inline bf16
+Float4ToBf16Unchecked(float num)
+{
+	union
+	{
+		float		f;
+		uint32		i;
+	}			swap;
+
+	swap.f = num;
+
+	/* Keep NaN quiet, since rounding could turn it into infinity */
+	if (isnan(num))
+		return (bf16) ((swap.i >> 16) | 0x0040);
+
+	/* Round to nearest even */
+	swap.i += 0x7FFF + ((swap.i >> 16) & 1);
+	return (bf16) (swap.i >> 16);
+}
+
+/*
+ * Convert a float4 to a bf16
+ */
+static inline bf16
+Float4ToBf16(float num)
+{
+	bf16		result = Float4ToBf16Unchecked(num);
+
+	if (unlikely(Bf16IsInf(result)) && !isinf(num))
+	{
+		char	   *buf = palloc(FLOAT_SHORTEST_DECIMAL_LEN);
+
+		float_to_shortest_decimal_buf(num, buf);
+
+		ereport(ERROR,
+				(errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
+				 errmsg("\"%s\" is out of range for type bf16vec", buf)));
+	}
+
+	return result;
+}
+
+#endif
@@ -0,0 +1,874 @@
+#include "postgres.h"
+
+#include <math.h>
+
+#include "bf16utils.h"
+#include "bf16vec.h"
+#include "catalog/pg_type.h"
+#include "common/shortest_dec.h"
+#include "fmgr.h"
+#include "halfutils.h"
+#include "halfvec.h"
+#include "lib/stringinfo.h"
+#include "libpq/pqformat.h"
+#include "port.h"				/* for strtof() */
+#include "utils/array.h"
+#include "utils/builtins.h"
+#include "utils/float.h"
+#include "utils/lsyscache.h"
+#include "utils/numeric.h"
+#include "vector.h"
+
+/*
+ * Ensure same dimensions
+ */
+static inline void
+CheckDims(Bf16Vector * a, Bf16Vector * b)
+{
+	if (a->dim != b->dim)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_EXCEPTION),
+				 errmsg("different bf16vec dimensions %d and %d", a->dim, b->dim)));
+}
+
+/*
+ * Ensure expected dimensions
+ */
+static inline void
+CheckExpectedDim(int32 typmod, int dim)
+{
+	if (typmod != -1 && typmod != dim)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_EXCEPTION),
+				 errmsg("expected %d dimensions, not %d", typmod, dim)));
+}
+
+/*
+ * Ensure valid dimensions
+ */
+static inline void
+CheckDim(int dim)
+{
+	if (dim < 1)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_EXCEPTION),
+				 errmsg("bf16vec must have at least 1 dimension")));
+
+	if (dim > BF16VEC_MAX_DIM)
+		ereport(ERROR,
+				(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+				 errmsg("bf16vec cannot have more than %d dimensions", BF16VEC_MAX_DIM)));
+}
+
+/*
+ * Ensure finite element
+ */
+static inline void
+CheckElement(bf16 value)
+{
+	if (Bf16IsNan(value))
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_EXCEPTION),
+				 errmsg("NaN not allowed in bf16vec")));
+
+	if (Bf16IsInf(value))
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_EXCEPTION),
+				 errmsg("infinite value not allowed in bf16vec")));
+}
+
+/*
+ * Allocate and initialize a new bf16 vector
+ */
+Bf16Vector *
+InitBf16Vector(int dim)
+{
+	Bf16Vector *result;
+	int			size;
+
+	size = BF16VEC_SIZE(dim);
+	result = (Bf16Vector *) palloc0(size);
+	SET_VARSIZE(result, size);
+	result->dim = dim;
+
+	return result;
+}
+
+/*
+ * Check for whitespace, since array_isspace() is static
+ */
+static inline bool
+bf16vec_isspace(char ch)
+{
+	if (ch == ' ' ||
+		ch == '\t' ||
+		ch == '\n' ||
+		ch == '\r' ||
+		ch == '\v' ||
+		ch == '\f')
+		return true;
+	return false;
+}
+
+/*
+ * Convert textual representation to internal representation
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(bf16vec_in);
+Datum
+bf16vec_in(PG_FUNCTION_ARGS)
+{
+	char	   *lit = PG_GETARG_CSTRING(0);
+	int32		typmod = PG_GETARG_INT32(2);
+	bf16		x[BF16VEC_MAX_DIM];
+	int			dim = 0;
+	char	   *pt = lit;
+	Bf16Vector *result;
+
+	while (bf16vec_isspace(*pt))
+		pt++;
+
+	if (*pt != '[')
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
+				 errmsg("invalid input syntax for type bf16vec: \"%s\"", lit),
+				 errdetail("Vector contents must start with \"[\".")));
+
+	pt++;
+
+	while (bf16vec_isspace(*pt))
+		pt++;
+
+	if (*pt == ']')
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_EXCEPTION),
+				 errmsg("bf16vec must have at least 1 dimension")));
+
+	for (;;)
+	{
+		float		val;
+		char	   *stringEnd;
+
+		if (dim == BF16VEC_MAX_DIM)
+			ereport(ERROR,
+					(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+					 errmsg("bf16vec cannot have more than %d dimensions", BF16VEC_MAX_DIM)));
+
+		while (bf16vec_isspace(*pt))
+			pt++;
+
+		/* Check for empty string like float4in */
+		if (*pt == '\0')
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
+					 errmsg("invalid input syntax for type bf16vec: \"%s\"", lit)));
+
+		errno = 0;
+
+		/* Postgres sets LC_NUMERIC to C on startup */
+		val = strtof(pt, &stringEnd);
+
+		if (stringEnd == pt)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
+					 errmsg("invalid input syntax for type bf16vec: \"%s\"", lit)));
+
+		x[dim] = Float4ToBf16Unchecked(val);
+
+		/* Check for range error like float4in */
+		if ((errno == ERANGE && isinf(val)) || (Bf16IsInf(x[dim]) && !isinf(val)))
+			ereport(ERROR,
+					(errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
+					 errmsg("\"%s\" is out of range for type bf16vec", pnstrdup(pt, stringEnd - pt))));
+
+		CheckElement(x[dim]);
+		dim++;
+
+		pt = stringEnd;
+
+		while (bf16vec_isspace(*pt))
+			pt++;
+
+		if (*pt == ',')
+			pt++;
+		else if (*pt == ']')
+		{
+			pt++;
+			break;
+		}
+		else
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
+					 errmsg("invalid input syntax for type bf16vec: \"%s\"", lit)));
+	}
+
+	/* Only whitespace is allowed after the closing brace */
+	while (bf16vec_isspace(*pt))
+		pt++;
+
+	if (*pt != '\0')
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
+				 errmsg("invalid input syntax for type bf16vec: \"%s\"", lit),
+				 errdetail("Junk after closing right brace.")));
+
+	CheckDim(dim);
+	CheckExpectedDim(typmod, dim);
+
+	result = InitBf16Vector(dim);
+	for (int i = 0; i < dim; i++)
+		result->x[i] = x[i];
+
+	PG_RETURN_POINTER(result);
+}
+
+#define AppendChar(ptr, c) (*(ptr)++ = (c))
+#define AppendFloat(ptr, f) ((ptr) += float_to_shortest_decimal_bufn((f), (ptr)))
+
+/*
+ * Convert internal representation to textual representation
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(bf16vec_out);
+Datum
+bf16vec_out(PG_FUNCTION_ARGS)
+{
+	Bf16Vector *vector = PG_GETARG_BF16VEC_P(0);
+	int			dim = vector->dim;
+	char	   *buf;
+	char	   *ptr;
+
+	/*
+	 * Need:
+	 *
+	 * dim * (FLOAT_SHORTEST_DECIMAL_LEN - 1) bytes for
+	 * float_to_shortest_decimal_bufn
+	 *
+	 * dim - 1 bytes for separator
+	 *
+	 * 3 bytes for [, ], and \0
+	 */
+	buf = (char *) palloc(FLOAT_SHORTEST_DECIMAL_LEN * dim + 2);
+	ptr = buf;
+
+	AppendChar(ptr, '[');
+
+	for (int i = 0; i < dim; i++)
+	{
+		if (i > 0)
+			AppendChar(ptr, ',');
+
+		/* Every bf16 is exactly representable as a float4 */
+		AppendFloat(ptr, Bf16ToFloat4(vector->x[i]));
+	}
+
+	AppendChar(ptr, ']');
+	*ptr = '\0';
+
+	PG_FREE_IF_COPY(vector, 0);
+	PG_RETURN_CSTRING(buf);
+}
+
+/*
+ * Convert type modifier
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(bf16vec_typmod_in);
+Datum
+bf16vec_typmod_in(PG_FUNCTION_ARGS)
+{
+	ArrayType  *ta = PG_GETARG_ARRAYTYPE_P(0);
+	int32	   *tl;
+	int			n;
+
+	tl = ArrayGetIntegerTypmods(ta, &n);
+
+	if (n != 1)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("invalid type modifier")));
+
+	if (*tl < 1)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("dimensions for type bf16vec must be at least 1")));
+
+	if (*tl > BF16VEC_MAX_DIM)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("dimensions for type bf16vec cannot exceed %d", BF16VEC_MAX_DIM)));
+
+	PG_RETURN_INT32(*tl);
+}
+
+/*
+ * Convert external binary representation to internal representation
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(bf16vec_recv);
+Datum
+bf16vec_recv(PG_FUNCTION_ARGS)
+{
+	StringInfo	buf = (StringInfo) PG_GETARG_POINTER(0);
+	int32		typmod = PG_GETARG_INT32(2);
+	Bf16Vector *result;
+	int16		dim;
+	int16		unused;
+
+	dim = pq_getmsgint(buf, sizeof(int16));
+	unused = pq_getmsgint(buf, sizeof(int16));
+
+	CheckDim(dim);
+	CheckExpectedDim(typmod, dim);
+
+	if (unused != 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_EXCEPTION),
+				 errmsg("expected unused to be 0, not %d", unused)));
+
+	result = InitBf16Vector(dim);
+	for (int i = 0; i < dim; i++)
+	{
+		result->x[i] = pq_getmsgint(buf, sizeof(bf16));
+		CheckElement(result->x[i]);
+	}
+
+	PG_RETURN_POINTER(result);
+}
+
+/*
+ * Convert internal representation to the external binary representation
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(bf16vec_send);
+Datum
+bf16vec_send(PG_FUNCTION_ARGS)
+{
+	Bf16Vector *vec = PG_GETARG_BF16VEC_P(0);
+	StringInfoData buf;
+
+	pq_begintypsend(&buf);
+	pq_sendint(&buf, vec->dim, sizeof(int16));
+	pq_sendint(&buf, vec->unused, sizeof(int16));
+	for (int i = 0; i < vec->dim; i++)
+		pq_sendint16(&buf, vec->x[i]);
+
+	PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+/*
+ * Convert bf16 vector to bf16 vector
+ * This is needed to check the type modifier
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(bf16vec);
+Datum
+bf16vec(PG_FUNCTION_ARGS)
+{
+	Bf16Vector *vec = PG_GETARG_BF16VEC_P(0);
+	int32		typmod = PG_GETARG_INT32(1);
+
+	CheckExpectedDim(typmod, vec->dim);
+
+	PG_RETURN_POINTER(vec);
+}
+
+/*
+ * Convert array to bf16 vector
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(array_to_bf16vec);
+Datum
+array_to_bf16vec(PG_FUNCTION_ARGS)
+{
+	ArrayType  *array = PG_GETARG_ARRAYTYPE_P(0);
+	int32		typmod = PG_GETARG_INT32(1);
+	Bf16Vector *result;
+	int16		typlen;
+	bool		typbyval;
+	char		typalign;
+	Datum	   *elemsp;
+	int			nelemsp;
+
+	if (ARR_NDIM(array) > 1)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_EXCEPTION),
+				 errmsg("array must be 1-D")));
+
+	if (ARR_HASNULL(array) && array_contains_nulls(array))
+		ereport(ERROR,
+				(errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+				 errmsg("array must not contain nulls")));
+
+	get_typlenbyvalalign(ARR_ELEMTYPE(array), &typlen, &typbyval, &typalign);
+	deconstruct_array(array, ARR_ELEMTYPE(array), typlen, typbyval, typalign, &elemsp, NULL, &nelemsp);
+
+	CheckDim(nelemsp);
+	CheckExpectedDim(typmod, nelemsp);
+
+	result = InitBf16Vector(nelemsp);
+
+	if (ARR_ELEMTYPE(array) == INT4OID)
+	{
+		for (int i = 0; i < nelemsp; i++)
+			result->x[i] = Float4ToBf16(DatumGetInt32(elemsp[i]));
+	}
+	else if (ARR_ELEMTYPE(array) == FLOAT8OID)
+	{
+		for (int i = 0; i < nelemsp; i++)
+			result->x[i] = Float4ToBf16(DatumGetFloat8(elemsp[i]));
+	}
+	else if (ARR_ELEMTYPE(array) == FLOAT4OID)
+	{
+		for (int i = 0; i < nelemsp; i++)
+			result->x[i] = Float4ToBf16(DatumGetFloat4(elemsp[i]));
+	}
+	else if (ARR_ELEMTYPE(array) == NUMERICOID)
+	{
+		for (int i = 0; i < nelemsp; i++)
+			result->x[i] = Float4ToBf16(DatumGetFloat4(DirectFunctionCall1(numeric_float4, elemsp[i])));
+	}
+	else
+	{
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_EXCEPTION),
+				 errmsg("unsupported array type")));
+	}
+
+	/*
+	 * Free allocation from deconstruct_array. Do not free individual elements
+	 * when pass-by-reference since they point to original array.
+	 */
+	pfree(elemsp);
+
+	/* Check elements */
+	for (int i = 0; i < result->dim; i++)
+		CheckElement(result->x[i]);
+
+	PG_RETURN_POINTER(result);
+}
+
+/*
+ * Convert bf16 vector to float4[]
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(bf16vec_to_float4);
+Datum
+bf16vec_to_float4(PG_FUNCTION_ARGS)
+{
+	Bf16Vector *vec = PG_GETARG_BF16VEC_P(0);
+	Datum	   *datums;
+	ArrayType  *result;
+
+	datums = (Datum *) palloc(sizeof(Datum) * vec->dim);
+
+	for (int i = 0; i < vec->dim; i++)
+		datums[i] = Float4GetDatum(Bf16ToFloat4(vec->x[i]));
+
+	/* Use TYPALIGN_INT for float4 */
+	result = construct_array(datums, vec->dim, FLOAT4OID, sizeof(float4), true, TYPALIGN_INT);
+
+	pfree(datums);
+
+	PG_RETURN_POINTER(result);
+}
+
+/*
+ * Convert vector to bf16 vector
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(vector_to_bf16vec);
+Datum
+vector_to_bf16vec(PG_FUNCTION_ARGS)
+{
+	Vector	   *vec = PG_GETARG_VECTOR_P(0);
+	int32		typmod = PG_GETARG_INT32(1);
+	Bf16Vector *result;
+
+	CheckDim(vec->dim);
+	CheckExpectedDim(typmod, vec->dim);
+
+	result = InitBf16Vector(vec->dim);
+
+	for (int i = 0; i < vec->dim; i++)
+		result->x[i] = Float4ToBf16(vec->x[i]);
+
+	PG_RETURN_POINTER(result);
+}
+
+/*
+ * Convert bf16 vector to vector
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(bf16vec_to_vector);
+Datum
+bf16vec_to_vector(PG_FUNCTION_ARGS)
+{
+	Bf16Vector *vec = PG_GETARG_BF16VEC_P(0);
+	int32		typmod = PG_GETARG_INT32(1);
+	Vector	   *result;
+
+	CheckExpectedDim(typmod, vec->dim);
+
+	result = InitVector(vec->dim);
+
+	/* Exact, since bf16 has the same exponent range as float4 */
+	for (int i = 0; i < vec->dim; i++)
+		result->x[i] = Bf16ToFloat4(vec->x[i]);
+
+	PG_RETURN_POINTER(result);
+}
+
+/*
+ * Convert half vector to bf16 vector
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(halfvec_to_bf16vec);
+Datum
+halfvec_to_bf16vec(PG_FUNCTION_ARGS)
+{
+	HalfVector *vec = PG_GETARG_HALFVEC_P(0);
+	int32		typmod = PG_GETARG_INT32(1);
+	Bf16Vector *result;
+
+	CheckExpectedDim(typmod, vec->dim);
+
+	result = InitBf16Vector(vec->dim);
+
+	for (int i = 0; i < vec->dim; i++)
+		result->x[i] = Float4ToBf16(HalfToFloat4(vec->x[i]));
+
+	PG_RETURN_POINTER(result);
+}
+
+/*
+ * Convert bf16 vector to half vector
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(bf16vec_to_halfvec);
+Datum
+bf16vec_to_halfvec(PG_FUNCTION_ARGS)
+{
+	Bf16Vector *vec = PG_GETARG_BF16VEC_P(0);
+	int32		typmod = PG_GETARG_INT32(1);
+	HalfVector *result;
+
+	CheckExpectedDim(typmod, vec->dim);
+
+	result = InitHalfVector(vec->dim);
+
+	for (int i = 0; i < vec->dim; i++)
+		result->x[i] = Float4ToHalf(Bf16ToFloat4(vec->x[i]));
+
+	PG_RETURN_POINTER(result);
+}
+
+/*
+ * Get the L2 distance between bf16 vectors
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(bf16vec_l2_distance);
+Datum
+bf16vec_l2_distance(PG_FUNCTION_ARGS)
+{
+	Bf16Vector *a = PG_GETARG_BF16VEC_P(0);
+	Bf16Vector *b = PG_GETARG_BF16VEC_P(1);
+
+	CheckDims(a, b);
+
+	PG_RETURN_FLOAT8(sqrt((double) Bf16vecL2SquaredDistance(a->dim, a->x, b->x)));
+}
+
+/*
+ * Get the L2 squared distance between bf16 vectors
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(bf16vec_l2_squared_distance);
+Datum
+bf16vec_l2_squared_distance(PG_FUNCTION_ARGS)
+{
+	Bf16Vector *a = PG_GETARG_BF16VEC_P(0);
+	Bf16Vector *b = PG_GETARG_BF16VEC_P(1);
+
+	CheckDims(a, b);
+
+	PG_RETURN_FLOAT8((double) Bf16vecL2SquaredDistance(a->dim, a->x, b->x));
+}
+
+/*
+ * Get the inner product of two bf16 vectors
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(bf16vec_inner_product);
+Datum
+bf16vec_inner_product(PG_FUNCTION_ARGS)
+{
+	Bf16Vector *a = PG_GETARG_BF16VEC_P(0);
+	Bf16Vector *b = PG_GETARG_BF16VEC_P(1);
+
+	CheckDims(a, b);
+
+	PG_RETURN_FLOAT8((double) Bf16vecInnerProduct(a->dim, a->x, b->x));
+}
+
+/*
+ * Get the negative inner product of two bf16 vectors
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(bf16vec_negative_inner_product);
+Datum
+bf16vec_negative_inner_product(PG_FUNCTION_ARGS)
+{
+	Bf16Vector *a = PG_GETARG_BF16VEC_P(0);
+	Bf16Vector *b = PG_GETARG_BF16VEC_P(1);
+
+	CheckDims(a, b);
+
+	PG_RETURN_FLOAT8((double) -Bf16vecInnerProduct(a->dim, a->x, b->x));
+}
+
+/*
+ * Get the cosine distance between two bf16 vectors
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(bf16vec_cosine_distance);
+Datum
+bf16vec_cosine_distance(PG_FUNCTION_ARGS)
+{
+	Bf16Vector *a = PG_GETARG_BF16VEC_P(0);
+	Bf16Vector *b = PG_GETARG_BF16VEC_P(1);
+	double		similarity;
+
+	CheckDims(a, b);
+
+	similarity = Bf16vecCosineSimilarity(a->dim, a->x, b->x);
+
+#ifdef _MSC_VER
+	/* /fp:fast may not propagate NaN */
+	if (isnan(similarity))
+		PG_RETURN_FLOAT8(NAN);
+#endif
+
+	/* Keep in range */
+	if (similarity > 1)
+		similarity = 1;
+	else if (similarity < -1)
+		similarity = -1;
+
+	PG_RETURN_FLOAT8(1 - similarity);
+}
+
+/*
+ * Get the distance for spherical k-means
+ * Currently uses angular distance since needs to satisfy triangle inequality
+ * Assumes inputs are unit vectors (skips norm)
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(bf16vec_spherical_distance);
+Datum
+bf16vec_spherical_distance(PG_FUNCTION_ARGS)
+{
+	Bf16Vector *a = PG_GETARG_BF16VEC_P(0);
+	Bf16Vector *b = PG_GETARG_BF16VEC_P(1);
+	double		distance;
+
+	CheckDims(a, b);
+
+	distance = (double) Bf16vecInnerProduct(a->dim, a->x, b->x);
+
+	/* Prevent NaN with acos with loss of precision */
+	if (distance > 1)
+		distance = 1;
+	else if (distance < -1)
+		distance = -1;
+
+	PG_RETURN_FLOAT8(acos(distance) / M_PI);
+}
+
+/*
+ * Get the L1 distance between two bf16 vectors
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(bf16vec_l1_distance);
+Datum
+bf16vec_l1_distance(PG_FUNCTION_ARGS)
+{
+	Bf16Vector *a = PG_GETARG_BF16VEC_P(0);
+	Bf16Vector *b = PG_GETARG_BF16VEC_P(1);
+
+	CheckDims(a, b);
+
+	PG_RETURN_FLOAT8((double) Bf16vecL1Distance(a->dim, a->x, b->x));
+}
+
+/*
+ * Get the dimensions of a bf16 vector
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(bf16vec_vector_dims);
+Datum
+bf16vec_vector_dims(PG_FUNCTION_ARGS)
+{
+	Bf16Vector *a = PG_GETARG_BF16VEC_P(0);
+
+	PG_RETURN_INT32(a->dim);
+}
+
+/*
+ * Get the L2 norm of a bf16 vector
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(bf16vec_l2_norm);
+Datum
+bf16vec_l2_norm(PG_FUNCTION_ARGS)
+{
+	Bf16Vector *a = PG_GETARG_BF16VEC_P(0);
+	bf16	   *ax = a->x;
+	double		norm = 0.0;
+
+	/* Auto-vectorized */
+	for (int i = 0; i < a->dim; i++)
+	{
+		double		axi = (double) Bf16ToFloat4(ax[i]);
+
+		norm += axi * axi;
+	}
+
+	PG_RETURN_FLOAT8(sqrt(norm));
+}
+
+/*
+ * Normalize a bf16 vector with the L2 norm
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(bf16vec_l2_normalize);
+Datum
+bf16vec_l2_normalize(PG_FUNCTION_ARGS)
+{
+	Bf16Vector *a = PG_GETARG_BF16VEC_P(0);
+	bf16	   *ax = a->x;
+	double		norm = 0;
+	Bf16Vector *result;
+	bf16	   *rx;
+
+	result = InitBf16Vector(a->dim);
+	rx = result->x;
+
+	/* Auto-vectorized */
+	for (int i = 0; i < a->dim; i++)
+		norm += (double) Bf16ToFloat4(ax[i]) * (double) Bf16ToFloat4(ax[i]);
+
+	norm = sqrt(norm);
+
+	/* Return zero vector for zero norm */
+	if (norm > 0)
+	{
+		for (int i = 0; i < a->dim; i++)
+			rx[i] = Float4ToBf16Unchecked(Bf16ToFloat4(ax[i]) / norm);
+
+		/* Check for overflow */
+		for (int i = 0; i < a->dim; i++)
+		{
+			if (Bf16IsInf(rx[i]))
+				float_overflow_error();
+		}
+	}
+
+	PG_RETURN_POINTER(result);
+}
+
+/*
+ * Internal helper to compare bf16 vectors
+ */
+static int
+bf16vec_cmp_internal(Bf16Vector * a, Bf16Vector * b)
+{
+	int			dim = Min(a->dim, b->dim);
+
+	/* Check values before dimensions to be consistent with Postgres arrays */
+	for (int i = 0; i < dim; i++)
+	{
+		if (Bf16ToFloat4(a->x[i]) < Bf16ToFloat4(b->x[i]))
+			return -1;
+
+		if (Bf16ToFloat4(a->x[i]) > Bf16ToFloat4(b->x[i]))
+			return 1;
+	}
+
+	if (a->dim < b->dim)
+		return -1;
+
+	if (a->dim > b->dim)
+		return 1;
+
+	return 0;
+}
+
+/*
+ * Less than
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(bf16vec_lt);
+Datum
+bf16vec_lt(PG_FUNCTION_ARGS)
+{
+	Bf16Vector *a = PG_GETARG_BF16VEC_P(0);
+	Bf16Vector *b = PG_GETARG_BF16VEC_P(1);
+
+	PG_RETURN_BOOL(bf16vec_cmp_internal(a, b) < 0);
+}
+
+/*
+ * Less than or equal
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(bf16vec_le);
+Datum
+bf16vec_le(PG_FUNCTION_ARGS)
+{
+	Bf16Vector *a = PG_GETARG_BF16VEC_P(0);
+	Bf16Vector *b = PG_GETARG_BF16VEC_P(1);
+
+	PG_RETURN_BOOL(bf16vec_cmp_internal(a, b) <= 0);
+}
+
+/*
+ * Equal
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(bf16vec_eq);
+Datum
+bf16vec_eq(PG_FUNCTION_ARGS)
+{
+	Bf16Vector *a = PG_GETARG_BF16VEC_P(0);
+	Bf16Vector *b = PG_GETARG_BF16VEC_P(1);
+
+	PG_RETURN_BOOL(bf16vec_cmp_internal(a, b) == 0);
+}
+
+/*
+ * Not equal
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(bf16vec_ne);
+Datum
+bf16vec_ne(PG_FUNCTION_ARGS)
+{
+	Bf16Vector *a = PG_GETARG_BF16VEC_P(0);
+	Bf16Vector *b = PG_GETARG_BF16VEC_P(1);
+
+	PG_RETURN_BOOL(bf16vec_cmp_internal(a, b) != 0);
+}
+
+/*
+ * Greater than or equal
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(bf16vec_ge);
+Datum
+bf16vec_ge(PG_FUNCTION_ARGS)
+{
+	Bf16Vector *a = PG_GETARG_BF16VEC_P(0);
+	Bf16Vector *b = PG_GETARG_BF16VEC_P(1);
+
+	PG_RETURN_BOOL(bf16vec_cmp_internal(a, b) >= 0);
+}
+
+/*
+ * Greater than
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(bf16vec_gt);
+Datum
+bf16vec_gt(PG_FUNCTION_ARGS)
+{
+	Bf16Vector *a = PG_GETARG_BF16VEC_P(0);
+	Bf16Vector *b = PG_GETARG_BF16VEC_P(1);
+
+	PG_RETURN_BOOL(bf16vec_cmp_internal(a, b) > 0);
+}
+
+/*
+ * Compare bf16 vectors
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(bf16vec_cmp);
+Datum
+bf16vec_cmp(PG_FUNCTION_ARGS)
+{
+	Bf16Vector *a = PG_GETARG_BF16VEC_P(0);
+	Bf16Vector *b = PG_GETARG_BF16VEC_P(1);
+
+	PG_RETURN_INT32(bf16vec_cmp_internal(a, b));
+}
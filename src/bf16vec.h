@@ -0,0 +1,31 @@
+#ifndef BF16VEC_H
+#define BF16VEC_H
+
+/* Same dispatch conditions as halfvec */
+#include "halfvec.h"
+
+#if defined(USE_DISPATCH)
+#define BF16VEC_DISPATCH
+#endif
+
+/* bfloat16 is stored as the upper 16 bits of a float4 */
+#define bf16 uint16
+
+#define BF16VEC_MAX_DIM 16000
+
+#define BF16VEC_SIZE(_dim)		(offsetof(Bf16Vector, x) + sizeof(bf16)*(_dim))
+#define DatumGetBf16Vector(x)	((Bf16Vector *) PG_DETOAST_DATUM(x))
+#define PG_GETARG_BF16VEC_P(x)	DatumGetBf16Vector(PG_GETARG_DATUM(x))
+#define PG_RETURN_BF16VEC_P(x)	PG_RETURN_POINTER(x)
+
+typedef struct Bf16Vector
+{
+	int32		vl_len_;		/* varlena header (do not touch directly!) */
+	int16		dim;			/* number of dimensions */
+	int16		unused;			/* reserved for future use, always zero */
+	bf16		x[FLEXIBLE_ARRAY_MEMBER];
+}			Bf16Vector;
+
+Bf16Vector *InitBf16Vector(int dim);
+
+#endif
@@ -0,0 +1,495 @@
+#include "postgres.h"
+
+#include <math.h>
+
+#include "access/genam.h"
+#include "access/itup.h"
+#include "access/table.h"
+#include "access/tableam.h"
+#include "catalog/index.h"
+#include "catalog/pg_class_d.h"
+#include "commands/defrem.h"
+#include "executor/tuptable.h"
+#include "fmgr.h"
+#include "funcapi.h"
+#include "hnsw.h"
+#include "ivfflat.h"
+#include "miscadmin.h"
+#include "storage/bufmgr.h"
+#include "utils/acl.h"
+#include "utils/datum.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+#include "utils/rls.h"
+#include "utils/snapmgr.h"
+#include "utils/tuplestore.h"
+
+/* Strategy number of the distance operator in the operator classes */
+#define DUPLICATES_DISTANCE_STRATEGY 1
+
+typedef struct DuplicatesState
+{
+	Relation	index;
+	Relation	heap;
+	IndexFetchTableData *fetch;
+	TupleTableSlot *slot;
+	Snapshot	snapshot;
+	FmgrInfo	procinfo;
+	Oid			collation;
+	double		epsilon;
+	Tuplestorestate *tupstore;
+	TupleDesc	tupdesc;
+	BufferAccessStrategy bas;
+	MemoryContext tmpCtx;
+}			DuplicatesState;
+
+/*
+ * Open the index and check access to its table
+ */
+static Relation
+OpenDuplicatesIndex(Oid relid)
+{
+	Relation	index = index_open(relid, AccessShareLock);
+	Oid			heapid = index->rd_index->indrelid;
+	Oid			userid = GetUserId();
+
+	if (index->rd_index->indnatts != 1)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("vector_near_duplicates does not support multicolumn indexes")));
+
+	/* Index tuples hold column values, so require access to the table */
+	if (pg_class_aclcheck(heapid, userid, ACL_SELECT) != ACLCHECK_OK)
+		aclcheck_error(ACLCHECK_NO_PRIV, OBJECT_TABLE, get_rel_name(heapid));
+
+	/* Reading the index directly would bypass policies */
+	if (check_enable_rls(heapid, InvalidOid, false) == RLS_ENABLED)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("vector_near_duplicates does not support row-level security")));
+
+	return index;
+}
+
+/*
+ * Get the function of the distance operator for the index
+ */
+static void
+GetDistanceFunction(Relation index, FmgrInfo *procinfo)
+{
+	Oid			opcintype = index->rd_opcintype[0];
+	Oid			opno;
+
+	opno = get_opfamily_member(index->rd_opfamily[0], opcintype, opcintype, DUPLICATES_DISTANCE_STRATEGY);
+	if (!OidIsValid(opno))
+		elog(ERROR, "missing distance operator for index \"%s\"", RelationGetRelationName(index));
+
+	fmgr_info(get_opcode(opno), procinfo);
+}
+
+/*
+ * Calculate the distance between values
+ */
+static inline double
+GetDistance(DuplicatesState * state, Datum a, Datum b)
+{
+	return DatumGetFloat8(FunctionCall2Coll(&state->procinfo, state->collation, a, b));
+}
+
+/*
+ * Check if a heap TID from the index is visible to the snapshot
+ *
+ * Index tuples are not removed until vacuum, so they can point to deleted
+ * or uncommitted rows
+ */
+static bool
+HeapTidIsVisible(DuplicatesState * state, ItemPointer heaptid)
+{
+	ItemPointerData tid = *heaptid;
+	bool		callAgain = false;
+	bool		allDead = false;
+	bool		found;
+
+	found = table_index_fetch_tuple(state->fetch, &tid, state->snapshot, state->slot, &callAgain, &allDead);
+	ExecClearTuple(state->slot);
+
+	return found;
+}
+
+/*
+ * Add a pair with the lower heap TID first
+ */
+static void
+AddPair(DuplicatesState * state, ItemPointer a, ItemPointer b, double distance)
+{
+	Datum		values[3];
+	bool		nulls[3] = {false, false, false};
+
+	if (!HeapTidIsVisible(state, a) || !HeapTidIsVisible(state, b))
+		return;
+
+	if (ItemPointerCompare(a, b) > 0)
+	{
+		ItemPointer tmp = a;
+
+		a = b;
+		b = tmp;
+	}
+
+	values[0] = PointerGetDatum(a);
+	values[1] = PointerGetDatum(b);
+	values[2] = Float8GetDatum(distance);
+	tuplestore_putvalues(state->tupstore, state->tupdesc, values, nulls);
+}
+
+/*
+ * Add pairs for all heap TIDs of two elements
+ */
+static void
+AddElementPairs(DuplicatesState * state, HnswElement a, HnswElement b, double distance)
+{
+	for (int i = 0; i < a->heaptidsLength; i++)
+	{
+		for (int j = 0; j < b->heaptidsLength; j++)
+			AddPair(state, &a->heaptids[i], &b->heaptids[j], distance);
+	}
+}
+
+/*
+ * Check if an element comes before another in the index
+ */
+static inline bool
+ElementPrecedes(HnswElement a, HnswElement b)
+{
+	return a->blkno < b->blkno || (a->blkno == b->blkno && a->offno < b->offno);
+}
+
+/*
+ * Check if an element is a layer 0 neighbor of another element
+ */
+static bool
+HasNeighbor(HnswElement element, HnswElement neighbor, ItemPointerData *indextids, Relation index, int m)
+{
+	int			lm = HnswGetLayerM(m, 0);
+
+	/* Treat a replaced neighbor tuple as not linked */
+	if (!HnswLoadNeighborTids(element, indextids, index, m, lm, 0))
+		return false;
+
+	for (int i = 0; i < lm; i++)
+	{
+		if (!ItemPointerIsValid(&indextids[i]))
+			break;
+
+		if (ItemPointerGetBlockNumber(&indextids[i]) == neighbor->blkno &&
+			ItemPointerGetOffsetNumber(&indextids[i]) == neighbor->offno)
+			return true;
+	}
+
+	return false;
+}
+
+/*
+ * Find near duplicates with the layer 0 graph of an HNSW index
+ *
+ * Each element is compared only with its neighbors. A link is followed from
+ * the element with the lower index TID, or from either end when it is only
+ * stored in one direction, so each pair is emitted once.
+ */
+static void
+HnswFindNearDuplicates(DuplicatesState * state)
+{
+	Relation	index = state->index;
+	char	   *base = NULL;
+	BlockNumber nblocks = RelationGetNumberOfBlocks(index);
+	HnswSupport support;
+	int			m;
+	int			lm;
+	ItemPointerData indextids[HNSW_MAX_M * 2];
+	ItemPointerData backtids[HNSW_MAX_M * 2];
+
+	/* Projected values are not comparable with the distance operator */
+	HnswInitSupport(&support, index);
+	if (support.projectDimensions > 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("vector_near_duplicates does not support project_dimensions")));
+
+	HnswGetMetaPageInfo(index, &m, NULL);
+	lm = HnswGetLayerM(m, 0);
+
+	for (BlockNumber blkno = HNSW_HEAD_BLKNO; blkno < nblocks; blkno++)
+	{
+		Buffer		buf;
+		Page		page;
+		OffsetNumber maxoffno;
+		List	   *elements = NIL;
+		ListCell   *lc;
+		MemoryContext oldCtx = MemoryContextSwitchTo(state->tmpCtx);
+
+		CHECK_FOR_INTERRUPTS();
+
+		/* Prevent vacuum from reusing elements like scans do */
+		LockPage(index, HNSW_SCAN_LOCK, ShareLock);
+
+		buf = ReadBufferExtended(index, MAIN_FORKNUM, blkno, RBM_NORMAL, state->bas);
+		LockBuffer(buf, BUFFER_LOCK_SHARE);
+		page = BufferGetPage(buf);
+		maxoffno = PageGetMaxOffsetNumber(page);
+
+		/* Copy elements to minimize lock time */
+		for (OffsetNumber offno = FirstOffsetNumber; offno <= maxoffno; offno = OffsetNumberNext(offno))
+		{
+			HnswElementTuple etup = (HnswElementTuple) PageGetItem(page, PageGetItemId(page, offno));
+			HnswElement element;
+
+			if (!HnswIsElementTuple(etup) || etup->deleted || !ItemPointerIsValid(&etup->heaptids[0]))
+				continue;
+
+			element = HnswInitElementFromBlock(blkno, offno);
+			HnswLoadElementFromTuple(element, etup, true, true);
+			elements = lappend(elements, element);
+		}
+
+		UnlockReleaseBuffer(buf);
+
+		foreach(lc, elements)
+		{
+			HnswElement element = lfirst(lc);
+			Datum		value = HnswGetValue(base, element);
+			double		distance;
+
+			/* Identical values share an element */
+			if (element->heaptidsLength > 1)
+			{
+				distance = GetDistance(state, value, value);
+				if (distance <= state->epsilon)
+				{
+					for (int i = 0; i < element->heaptidsLength; i++)
+					{
+						for (int j = i + 1; j < element->heaptidsLength; j++)
+							AddPair(state, &element->heaptids[i], &element->heaptids[j], distance);
+					}
+				}
+			}
+
+			if (!HnswLoadNeighborTids(element, indextids, index, m, lm, 0))
+				continue;
+
+			for (int i = 0; i < lm; i++)
+			{
+				ItemPointer indextid = &indextids[i];
+				HnswElement neighbor;
+
+				if (!ItemPointerIsValid(indextid))
+					break;
+
+				neighbor = HnswInitElementFromBlock(ItemPointerGetBlockNumber(indextid), ItemPointerGetOffsetNumber(indextid));
+				HnswLoadElement(neighbor, NULL, NULL, index, NULL, true, NULL);
+
+				if (neighbor->deleted || neighbor->heaptidsLength == 0)
+					continue;
+
+				distance = GetDistance(state, value, HnswGetValue(base, neighbor));
+				if (distance > state->epsilon)
+					continue;
+
+				/* Skip links the neighbor also has, since it emits those */
+				if (ElementPrecedes(neighbor, element) && HasNeighbor(neighbor, element, backtids, index, m))
+					continue;
+
+				AddElementPairs(state, element, neighbor, distance);
+			}
+		}
+
+		UnlockPage(index, HNSW_SCAN_LOCK, ShareLock);
+
+		MemoryContextSwitchTo(oldCtx);
+		MemoryContextReset(state->tmpCtx);
+	}
+}
+
+/*
+ * Find near duplicates within the lists of an IVFFlat index
+ *
+ * Every pair in a list is compared, so pairs split across lists are missed.
+ * Time is quadratic in the number of rows per list (about rows^2 / lists in
+ * total), so a large table with few lists is slow. Interrupts are checked
+ * for each row, and the list is held in memory while it is compared.
+ */
+static void
+IvfflatFindNearDuplicates(DuplicatesState * state)
+{
+	Relation	index = state->index;
+	TupleDesc	tupdesc = RelationGetDescr(index);
+	BlockNumber blkno = IVFFLAT_HEAD_BLKNO;
+
+	/* Iterate over list pages */
+	while (BlockNumberIsValid(blkno))
+	{
+		Buffer		cbuf;
+		Page		cpage;
+		OffsetNumber coffno;
+		OffsetNumber cmaxoffno;
+		BlockNumber listPages[MaxOffsetNumber];
+
+		cbuf = ReadBuffer(index, blkno);
+		LockBuffer(cbuf, BUFFER_LOCK_SHARE);
+		cpage = BufferGetPage(cbuf);
+
+		cmaxoffno = PageGetMaxOffsetNumber(cpage);
+
+		/* Iterate over lists */
+		for (coffno = FirstOffsetNumber; coffno <= cmaxoffno; coffno = OffsetNumberNext(coffno))
+		{
+			IvfflatList list = (IvfflatList) PageGetItem(cpage, PageGetItemId(cpage, coffno));
+
+			listPages[coffno - FirstOffsetNumber] = list->startPage;
+		}
+
+		blkno = IvfflatPageGetOpaque(cpage)->nextblkno;
+
+		UnlockReleaseBuffer(cbuf);
+
+		for (coffno = FirstOffsetNumber; coffno <= cmaxoffno; coffno = OffsetNumberNext(coffno))
+		{
+			BlockNumber searchPage = listPages[coffno - FirstOffsetNumber];
+			int			length = 0;
+			int			maxLength = 1024;
+			Datum	   *values;
+			ItemPointerData *heaptids;
+			MemoryContext oldCtx = MemoryContextSwitchTo(state->tmpCtx);
+
+			values = palloc(sizeof(Datum) * maxLength);
+			heaptids = palloc(sizeof(ItemPointerData) * maxLength);
+
+			/* Load the list */
+			while (BlockNumberIsValid(searchPage))
+			{
+				Buffer		buf;
+				Page		page;
+				OffsetNumber maxoffno;
+
+				CHECK_FOR_INTERRUPTS();
+
+				buf = ReadBufferExtended(index, MAIN_FORKNUM, searchPage, RBM_NORMAL, state->bas);
+				LockBuffer(buf, BUFFER_LOCK_SHARE);
+				page = BufferGetPage(buf);
+				maxoffno = PageGetMaxOffsetNumber(page);
+
+				for (OffsetNumber offno = FirstOffsetNumber; offno <= maxoffno; offno = OffsetNumberNext(offno))
+				{
+					IndexTuple	itup = (IndexTuple) PageGetItem(page, PageGetItemId(page, offno));
+					bool		isnull;
+					Datum		value = index_getattr(itup, 1, tupdesc, &isnull);
+
+					if (length == maxLength)
+					{
+						maxLength *= 2;
+						values = repalloc_huge(values, sizeof(Datum) * maxLength);
+						heaptids = repalloc_huge(heaptids, sizeof(ItemPointerData) * maxLength);
+					}
+
+					values[length] = datumCopy(value, false, -1);
+					heaptids[length] = itup->t_tid;
+					length++;
+				}
+
+				searchPage = IvfflatPageGetOpaque(page)->nextblkno;
+
+				UnlockReleaseBuffer(buf);
+			}
+
+			/* Compare all pairs in the list */
+			for (int i = 0; i < length; i++)
+			{
+				CHECK_FOR_INTERRUPTS();
+
+				for (int j = i + 1; j < length; j++)
+				{
+					double		distance = GetDistance(state, values[i], values[j]);
+
+					if (distance <= state->epsilon)
+						AddPair(state, &heaptids[i], &heaptids[j], distance);
+				}
+			}
+
+			MemoryContextSwitchTo(oldCtx);
+			MemoryContextReset(state->tmpCtx);
+		}
+	}
+}
+
+/*
+ * Find pairs of rows within a distance of each other with an index
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(vector_near_duplicates);
+Datum
+vector_near_duplicates(PG_FUNCTION_ARGS)
+{
+	Oid			relid = PG_GETARG_OID(0);
+	double		epsilon = PG_GETARG_FLOAT8(1);
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	DuplicatesState state;
+	MemoryContext oldCtx;
+	char	   *amname;
+
+	if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo) || !(rsinfo->allowedModes & SFRM_Materialize))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("set-valued function called in context that cannot accept a set")));
+
+	if (isnan(epsilon))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("epsilon must not be NaN")));
+
+	if (get_rel_relkind(relid) != RELKIND_INDEX)
+		ereport(ERROR,
+				(errcode(ERRCODE_WRONG_OBJECT_TYPE),
+				 errmsg("\"%s\" is not an index", get_rel_name(relid))));
+
+	/* Lock the table before the index like other commands */
+	state.heap = table_open(IndexGetRelation(relid, false), AccessShareLock);
+	state.index = OpenDuplicatesIndex(relid);
+	state.fetch = table_index_fetch_begin(state.heap);
+	state.slot = table_slot_create(state.heap, NULL);
+	state.snapshot = GetActiveSnapshot();
+	state.collation = state.index->rd_indcollation[0];
+	state.epsilon = epsilon;
+	GetDistanceFunction(state.index, &state.procinfo);
+
+	oldCtx = MemoryContextSwitchTo(rsinfo->econtext->ecxt_per_query_memory);
+	if (get_call_result_type(fcinfo, NULL, &state.tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+	state.tupstore = tuplestore_begin_heap(true, false, work_mem);
+	rsinfo->returnMode = SFRM_Materialize;
+	rsinfo->setResult = state.tupstore;
+	rsinfo->setDesc = state.tupdesc;
+	MemoryContextSwitchTo(oldCtx);
+
+	state.bas = GetAccessStrategy(BAS_BULKREAD);
+	state.tmpCtx = AllocSetContextCreate(CurrentMemoryContext,
+										 "Near duplicates temporary context",
+										 ALLOCSET_DEFAULT_SIZES);
+
+	amname = get_am_name(state.index->rd_rel->relam);
+	if (strcmp(amname, "hnsw") == 0)
+		HnswFindNearDuplicates(&state);
+	else if (strcmp(amname, "ivfflat") == 0)
+		IvfflatFindNearDuplicates(&state);
+	else
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("vector_near_duplicates only supports hnsw and ivfflat indexes")));
+
+	FreeAccessStrategy(state.bas);
+	MemoryContextDelete(state.tmpCtx);
+	ExecDropSingleTupleTableSlot(state.slot);
+	table_index_fetch_end(state.fetch);
+	table_close(state.heap, AccessShareLock);
+	index_close(state.index, AccessShareLock);
+
+	return (Datum) 0;
+}
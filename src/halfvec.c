@@ -670,6 +670,30 @@ halfvec_l1_distance(PG_FUNCTION_ARGS)
 	PG_RETURN_FLOAT8((double) HalfvecL1Distance(a->dim, a->x, b->x));
 }
 
+/*
+ * Check if the L2 distance between two half vectors is within a threshold
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(halfvec_l2_within);
+Datum
+halfvec_l2_within(PG_FUNCTION_ARGS)
+{
+	Datum		distance = DirectFunctionCall2(halfvec_l2_distance, PG_GETARG_DATUM(0), PG_GETARG_DATUM(1));
+
+	PG_RETURN_BOOL(DatumGetFloat8(distance) <= PG_GETARG_FLOAT8(2));
+}
+
+/*
+ * Check if the cosine distance between two half vectors is within a threshold
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(halfvec_cosine_within);
+Datum
+halfvec_cosine_within(PG_FUNCTION_ARGS)
+{
+	Datum		distance = DirectFunctionCall2(halfvec_cosine_distance, PG_GETARG_DATUM(0), PG_GETARG_DATUM(1));
+
+	PG_RETURN_BOOL(DatumGetFloat8(distance) <= PG_GETARG_FLOAT8(2));
+}
+
 /*
  * Get the dimensions of a half vector
  */
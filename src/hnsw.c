@@ -29,6 +29,7 @@ int			hnsw_ef_search;
 int			hnsw_iterative_scan;
 int			hnsw_max_scan_tuples;
 double		hnsw_scan_mem_multiplier;
+int			hnsw_analyze_searches;
 int			hnsw_lock_tranche_id;
 static relopt_kind hnsw_relopt_kind;
 
@@ -82,6 +83,14 @@ HnswInit(void)
 					  HNSW_DEFAULT_M, HNSW_MIN_M, HNSW_MAX_M, AccessExclusiveLock);
 	add_int_reloption(hnsw_relopt_kind, "ef_construction", "Size of the dynamic candidate list for construction",
 					  HNSW_DEFAULT_EF_CONSTRUCTION, HNSW_MIN_EF_CONSTRUCTION, HNSW_MAX_EF_CONSTRUCTION, AccessExclusiveLock);
+	add_real_reloption(hnsw_relopt_kind, "alpha", "Pruning factor for neighbor selection",
+					   HNSW_DEFAULT_ALPHA, HNSW_MIN_ALPHA, HNSW_MAX_ALPHA, AccessExclusiveLock);
+	add_int_reloption(hnsw_relopt_kind, "ef_search", "Min size of the dynamic candidate list for search",
+					  0, 0, HNSW_MAX_EF_SEARCH, ShareUpdateExclusiveLock);
+	add_int_reloption(hnsw_relopt_kind, "project_dimensions", "Number of dimensions to keep after a random rotation",
+					  0, 0, HNSW_MAX_DIM, AccessExclusiveLock);
+	add_int_reloption(hnsw_relopt_kind, "prefix_dimensions", "Number of leading dimensions to use for graph traversal",
+					  0, 0, HNSW_MAX_DIM, AccessExclusiveLock);
 
 	DefineCustomIntVariable("hnsw.ef_search", "Sets the size of the dynamic candidate list for search",
 							"Valid range is 1..1000.", &hnsw_ef_search,
@@ -101,6 +110,10 @@ HnswInit(void)
 							 NULL, &hnsw_scan_mem_multiplier,
 							 1, 1, 1000, PGC_USERSET, 0, NULL, NULL, NULL);
 
+	DefineCustomIntVariable("hnsw.analyze_searches", "Sets the number of sample searches for ANALYZE",
+							"Zero disables sampling.", &hnsw_analyze_searches,
+							0, 0, 1000, PGC_USERSET, 0, NULL, NULL, NULL);
+
 	MarkGUCPrefixReserved("hnsw");
 }
 
@@ -132,6 +145,8 @@ hnswcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
 {
 	GenericCosts costs;
 	int			m;
+	double		scalingFactor;
+	int			efSearch;
 	double		ratio;
 	double		startupPages;
 	double		spc_seq_page_cost;
@@ -157,7 +172,8 @@ hnswcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
 	genericcostestimate(root, path, loop_count, &costs);
 
 	index = index_open(path->indexinfo->indexoid, NoLock);
-	HnswGetMetaPageInfo(index, &m, NULL);
+	HnswGetMetaPageCostInfo(index, &m, &scalingFactor);
+	efSearch = HnswGetEfSearch(index);
 	index_close(index, NoLock);
 
 	/*
@@ -168,10 +184,11 @@ hnswcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
 	 * ef_search - which influences the total number of steps taken at layer 0
 	 *
 	 * The source of the vector data can impact how many steps it takes to
-	 * converge on the set of vectors to return to the executor. Currently, we
-	 * use a hardcoded scaling factor (HNSWScanScalingFactor) to help
-	 * influence that, but this could later become a configurable parameter
-	 * based on the cost estimations.
+	 * converge on the set of vectors to return to the executor. We use a
+	 * scaling factor to help influence that. It defaults to a value that
+	 * works well for uniformly random data (which is close to the worst
+	 * case) and is lowered by ANALYZE when sample searches visit fewer
+	 * tuples.
 	 *
 	 * The tuple estimator formula is below:
 	 *
@@ -185,16 +202,11 @@ hnswcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
 	 *
 	 * "layer0Selectivity" estimates the percentage of tuples that are scanned
 	 * at L0, accounting for previously visited tuples, multiplied by the
-	 * "scalingFactor" (currently hardcoded).
+	 * "scalingFactor".
 	 */
 	if (path->indexinfo->tuples > 0)
 	{
-		double		scalingFactor = 0.55;
-		int			entryLevel = (int) (log(path->indexinfo->tuples) * HnswGetMl(m));
-		int			layer0TuplesMax = HnswGetLayerM(m, 0) * hnsw_ef_search;
-		double		layer0Selectivity = scalingFactor * log(path->indexinfo->tuples) / (log(m) * (1 + log(hnsw_ef_search)));
-
-		ratio = (entryLevel * m + layer0TuplesMax * layer0Selectivity) / path->indexinfo->tuples;
+		ratio = HnswEstimateScanTuples(path->indexinfo->tuples, m, efSearch, scalingFactor) / path->indexinfo->tuples;
 
 		if (ratio > 1)
 			ratio = 1;
@@ -234,6 +246,10 @@ hnswoptions(Datum reloptions, bool validate)
 	static const relopt_parse_elt tab[] = {
 		{"m", RELOPT_TYPE_INT, offsetof(HnswOptions, m)},
 		{"ef_construction", RELOPT_TYPE_INT, offsetof(HnswOptions, efConstruction)},
+		{"alpha", RELOPT_TYPE_REAL, offsetof(HnswOptions, alpha)},
+		{"ef_search", RELOPT_TYPE_INT, offsetof(HnswOptions, efSearch)},
+		{"project_dimensions", RELOPT_TYPE_INT, offsetof(HnswOptions, projectDimensions)},
+		{"prefix_dimensions", RELOPT_TYPE_INT, offsetof(HnswOptions, prefixDimensions)},
 	};
 
 	return (bytea *) build_reloptions(reloptions, validate,
@@ -39,9 +39,13 @@
 #define HNSW_DEFAULT_EF_CONSTRUCTION	64
 #define HNSW_MIN_EF_CONSTRUCTION	4
 #define HNSW_MAX_EF_CONSTRUCTION		1000
+#define HNSW_DEFAULT_ALPHA	1.0
+#define HNSW_MIN_ALPHA		1.0
+#define HNSW_MAX_ALPHA		2.0
 #define HNSW_DEFAULT_EF_SEARCH	40
 #define HNSW_MIN_EF_SEARCH		1
 #define HNSW_MAX_EF_SEARCH		1000
+#define HNSW_DEFAULT_SCALING_FACTOR	0.55
 
 /* Tuple types */
 #define HNSW_ELEMENT_TUPLE_TYPE  1
@@ -53,6 +57,9 @@
 #define HNSW_UPDATE_ENTRY_GREATER 1
 #define HNSW_UPDATE_ENTRY_ALWAYS 2
 
+/* Max pages an insert skips when locked by another backend */
+#define HNSW_MAX_SKIPPED_PAGES 3
+
 /* Build phases */
 /* PROGRESS_CREATEIDX_SUBPHASE_INITIALIZE is 1 */
 #define PROGRESS_HNSW_PHASE_LOAD		2
@@ -112,6 +119,7 @@ extern int	hnsw_ef_search;
 extern int	hnsw_iterative_scan;
 extern int	hnsw_max_scan_tuples;
 extern double hnsw_scan_mem_multiplier;
+extern int	hnsw_analyze_searches;
 extern int	hnsw_lock_tranche_id;
 
 typedef enum HnswIterativeScanMode
@@ -183,6 +191,10 @@ typedef struct HnswOptions
 	int32		vl_len_;		/* varlena header (do not touch directly!) */
 	int			m;				/* number of connections */
 	int			efConstruction; /* size of dynamic candidate list */
+	double		alpha;			/* pruning factor for neighbor selection */
+	int			efSearch;		/* min size of dynamic candidate list for search */
+	int			projectDimensions;	/* dimensions after random rotation */
+	int			prefixDimensions;	/* leading dimensions for traversal */
 }			HnswOptions;
 
 typedef struct HnswGraph
@@ -249,6 +261,7 @@ typedef struct HnswTypeInfo
 	int			maxDimensions;
 	Datum		(*normalize) (PG_FUNCTION_ARGS);
 	void		(*checkValue) (Pointer v);
+	Datum		(*interpolate) (Pointer a, Pointer b, float t);
 }			HnswTypeInfo;
 
 typedef struct HnswSupport
@@ -256,6 +269,10 @@ typedef struct HnswSupport
 	FmgrInfo   *procinfo;
 	FmgrInfo   *normprocinfo;
 	Oid			collation;
+	float		alpha;
+	int			projectDimensions;
+	int			prefixDimensions;
+	double		(*prefixDistance) (int dim, float *ax, float *bx);
 }			HnswSupport;
 
 typedef struct HnswQuery
@@ -312,6 +329,9 @@ typedef struct HnswMetaPageData
 	OffsetNumber entryOffno;
 	int16		entryLevel;
 	BlockNumber insertPage;
+	float		scalingFactor;	/* from ANALYZE (zero if not sampled) */
+	uint16		projectDimensions;	/* from build (zero if disabled) */
+	uint16		prefixDimensions;	/* from build (zero if disabled) */
 }			HnswMetaPageData;
 
 typedef HnswMetaPageData * HnswMetaPage;
@@ -369,6 +389,7 @@ typedef struct HnswScanOpaqueData
 	List	   *w;
 	visited_hash v;
 	pairingheap *discarded;
+	pairingheap *rescored;
 	HnswQuery	q;
 	int			m;
 	int64		tuples;
@@ -410,16 +431,24 @@ typedef struct HnswVacuumState
 /* Methods */
 int			HnswGetM(Relation index);
 int			HnswGetEfConstruction(Relation index);
+double		HnswGetAlpha(Relation index);
+int			HnswGetEfSearch(Relation index);
+int			HnswGetProjectDimensions(Relation index);
+int			HnswGetPrefixDimensions(Relation index);
 FmgrInfo   *HnswOptionalProcInfo(Relation index, uint16 procnum);
 void		HnswInitSupport(HnswSupport * support, Relation index);
+void		HnswInitBuildSupport(HnswSupport * support, Relation index, int projectDimensions, int prefixDimensions);
 Datum		HnswNormValue(const HnswTypeInfo * typeInfo, Oid collation, Datum value);
 bool		HnswCheckNorm(HnswSupport * support, Datum value);
+Datum		HnswProjectValue(Datum value, int dimensions);
 Buffer		HnswNewBuffer(Relation index, ForkNumber forkNum);
 void		HnswInitPage(Buffer buf, Page page);
 void		HnswInit(void);
 List	   *HnswSearchLayer(char *base, HnswQuery * q, List *ep, int ef, int lc, Relation index, HnswSupport * support, int m, bool inserting, HnswElement skipElement, visited_hash * v, pairingheap **discarded, bool initVisited, int64 *tuples);
 HnswElement HnswGetEntryPoint(Relation index);
 void		HnswGetMetaPageInfo(Relation index, int *m, HnswElement * entryPoint);
+void		HnswGetMetaPageCostInfo(Relation index, int *m, double *scalingFactor);
+double		HnswEstimateScanTuples(double tuples, int m, int efSearch, double scalingFactor);
 void	   *HnswAlloc(HnswAllocator * allocator, Size size);
 HnswElement HnswInitElement(char *base, ItemPointer tid, int m, double ml, int maxLevel, HnswAllocator * alloc);
 HnswElement HnswInitElementFromBlock(BlockNumber blkno, OffsetNumber offno);
@@ -434,6 +463,7 @@ bool		HnswInsertTupleOnDisk(Relation index, HnswSupport * support, Datum value,
 void		HnswUpdateNeighborsOnDisk(Relation index, HnswSupport * support, HnswElement e, int m, bool checkExisting, bool building);
 void		HnswLoadElementFromTuple(HnswElement element, HnswElementTuple etup, bool loadHeaptids, bool loadVec);
 void		HnswLoadElement(HnswElement element, double *distance, HnswQuery * q, Relation index, HnswSupport * support, bool loadVec, double *maxDistance);
+double		HnswGetFullDistance(HnswElement element, HnswQuery * q, Relation index, HnswSupport * support);
 bool		HnswFormIndexValue(Datum *out, Datum *values, bool *isnull, const HnswTypeInfo * typeInfo, HnswSupport * support);
 void		HnswSetElementTuple(char *base, HnswElementTuple etup, HnswElement element);
 void		HnswUpdateConnection(char *base, HnswNeighborArray * neighbors, HnswElement newElement, float distance, int lm, int *updateIdx, Relation index, HnswSupport * support);
@@ -38,6 +38,11 @@
 
 #include <math.h>
 
+#ifndef WIN32
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
 #include "access/parallel.h"
 #include "access/table.h"
 #include "access/tableam.h"
@@ -48,10 +53,14 @@
 #include "commands/progress.h"
 #include "hnsw.h"
 #include "miscadmin.h"
+#include "numautils.h"
 #include "optimizer/optimizer.h"
 #include "storage/bufmgr.h"
+#include "storage/fd.h"
+#include "storage/pg_shmem.h"
 #include "tcop/tcopprot.h"
 #include "utils/datum.h"
+#include "utils/guc.h"
 #include "utils/memutils.h"
 
 #if PG_VERSION_NUM >= 160000
@@ -100,6 +109,9 @@ CreateMetaPage(HnswBuildState * buildstate)
 	metap->entryOffno = InvalidOffsetNumber;
 	metap->entryLevel = -1;
 	metap->insertPage = InvalidBlockNumber;
+	metap->scalingFactor = 0;
+	metap->projectDimensions = buildstate->support.projectDimensions;
+	metap->prefixDimensions = buildstate->support.prefixDimensions;
 	((PageHeader) page)->pd_lower =
 		((char *) metap + sizeof(HnswMetaPageData)) - (char *) page;
 
@@ -660,6 +672,9 @@ HnswSharedMemoryAlloc(Size size, void *state)
 static void
 InitBuildState(HnswBuildState * buildstate, Relation heap, Relation index, IndexInfo *indexInfo, ForkNumber forkNum)
 {
+	int			projectDimensions;
+	int			prefixDimensions;
+
 	buildstate->heap = heap;
 	buildstate->index = index;
 	buildstate->indexInfo = indexInfo;
@@ -682,7 +697,22 @@ InitBuildState(HnswBuildState * buildstate, Relation heap, Relation index, Index
 				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
 				 errmsg("column does not have dimensions")));
 
-	if (buildstate->dimensions > buildstate->typeInfo->maxDimensions)
+	projectDimensions = HnswGetProjectDimensions(index);
+	if (projectDimensions > 0)
+	{
+		/* Only vector has the default type info */
+		if (HnswOptionalProcInfo(index, HNSW_TYPE_INFO_PROC) != NULL)
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("project_dimensions is only supported for vector")));
+
+		if (projectDimensions >= buildstate->dimensions)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("project_dimensions must be less than column dimensions")));
+	}
+	/* Projected indexes store fewer dimensions, so skip the limit */
+	else if (buildstate->dimensions > buildstate->typeInfo->maxDimensions)
 		ereport(ERROR,
 				(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
 				 errmsg("column cannot have more than %d dimensions for hnsw index", buildstate->typeInfo->maxDimensions)));
@@ -695,8 +725,20 @@ InitBuildState(HnswBuildState * buildstate, Relation heap, Relation index, Index
 	buildstate->reltuples = 0;
 	buildstate->indtuples = 0;
 
+	prefixDimensions = HnswGetPrefixDimensions(index);
+	if (prefixDimensions >= (projectDimensions > 0 ? projectDimensions : buildstate->dimensions))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("prefix_dimensions must be less than indexed dimensions")));
+
 	/* Get support functions */
-	HnswInitSupport(&buildstate->support, index);
+	HnswInitBuildSupport(&buildstate->support, index, projectDimensions, prefixDimensions);
+
+	/* Only vector distance functions have prefix equivalents */
+	if (prefixDimensions > 0 && buildstate->support.prefixDistance == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("prefix_dimensions is only supported for vector")));
 
 	InitGraph(&buildstate->graphData, NULL, (Size) maintenance_work_mem * 1024L);
 	buildstate->graph = &buildstate->graphData;
@@ -805,6 +847,105 @@ HnswParallelScanAndInsert(Relation heapRel, Relation indexRel, HnswShared * hnsw
 	FreeBuildState(&buildstate);
 }
 
+#ifdef MADV_HUGEPAGE
+/*
+ * Get the size of transparent huge pages
+ */
+static Size
+HnswHugePageSize(void)
+{
+	Size		size = 2 * 1024 * 1024;
+#ifdef __linux__
+	FILE	   *file = AllocateFile("/sys/kernel/mm/transparent_hugepage/hpage_pmd_size", "r");
+
+	if (file != NULL)
+	{
+		unsigned long value;
+
+		if (fscanf(file, "%lu", &value) == 1 && value > 0 && (value & (value - 1)) == 0)
+			size = value;
+
+		FreeFile(file);
+	}
+#endif
+
+	return size;
+}
+#endif
+
+/*
+ * Request huge pages for the graph area
+ *
+ * Neighbor access during the build is random, so a large graph on regular
+ * pages thrashes the TLB. The advice applies to the mapping in the calling
+ * process, so every participant needs to request it.
+ */
+static void
+HnswAdviseHugePages(char *area, Size size)
+{
+#ifdef MADV_HUGEPAGE
+	Size		pageSize = sysconf(_SC_PAGESIZE);
+	char	   *start = (char *) TYPEALIGN(pageSize, area);
+	char	   *end = (char *) TYPEALIGN_DOWN(pageSize, area + size);
+
+	if (huge_pages == HUGE_PAGES_OFF || end <= start)
+		return;
+
+	if (madvise(start, end - start, MADV_HUGEPAGE) != 0)
+		ereport(DEBUG1,
+				(errmsg("could not request huge pages for hnsw graph: %m")));
+#endif
+}
+
+/*
+ * Report the page size backing the graph area
+ */
+static void
+HnswReportPageSize(char *area, Size size)
+{
+#ifdef __linux__
+	FILE	   *file;
+	char		line[256];
+	bool		overlaps = false;
+	Size		pageSize = 0;
+	Size		hugeSize = 0;
+
+	file = AllocateFile("/proc/self/smaps", "r");
+	if (file == NULL)
+		return;
+
+	while (fgets(line, sizeof(line), file) != NULL)
+	{
+		unsigned long start;
+		unsigned long end;
+		Size		value;
+
+		/* Mapping header */
+		if (sscanf(line, "%lx-%lx ", &start, &end) == 2)
+		{
+			overlaps = start < (unsigned long) (area + size) && end > (unsigned long) area;
+			continue;
+		}
+
+		if (!overlaps)
+			continue;
+
+		if (sscanf(line, "KernelPageSize: %zu kB", &value) == 1)
+			pageSize = Max(pageSize, value);
+		else if (sscanf(line, "ShmemPmdMapped: %zu kB", &value) == 1 ||
+				 sscanf(line, "FilePmdMapped: %zu kB", &value) == 1 ||
+				 sscanf(line, "AnonHugePages: %zu kB", &value) == 1)
+			hugeSize += value;
+	}
+
+	FreeFile(file);
+
+	if (pageSize > 0)
+		ereport(DEBUG1,
+				(errmsg("hnsw graph used %zu kB pages with %zu kB in transparent huge pages", pageSize, hugeSize)));
+#endif
+}
+
 /*
  * Perform work within a launched parallel process
  */
@@ -845,7 +986,11 @@ HnswParallelBuildMain(dsm_segment *seg, shm_toc *toc)
 	heapRel = table_open(hnswshared->heaprelid, heapLockmode);
 	indexRel = index_open(hnswshared->indexrelid, indexLockmode);
 
+	/* Run on one node so private memory is local */
+	NumaSetWorkerAffinity(ParallelWorkerNumber);
+
 	hnswarea = shm_toc_lookup(toc, PARALLEL_KEY_HNSW_AREA, false);
+	HnswAdviseHugePages(hnswarea, hnswshared->graphData.memoryTotal);
 
 	/* Perform inserts */
 	HnswParallelScanAndInsert(heapRel, indexRel, hnswshared, hnswarea, false);
@@ -903,6 +1048,7 @@ HnswBeginParallel(HnswBuildState * buildstate, bool isconcurrent, int request)
 	Size		esthnswshared;
 	Size		esthnswarea;
 	Size		estother;
+	Size		hugepageslack = 0;
 	HnswShared *hnswshared;
 	char	   *hnswarea;
 	HnswLeader *hnswleader = (HnswLeader *) palloc0(sizeof(HnswLeader));
@@ -936,7 +1082,13 @@ HnswBeginParallel(HnswBuildState * buildstate, bool isconcurrent, int request)
 	if (esthnswarea > estother)
 		esthnswarea -= estother;
 
-	shm_toc_estimate_chunk(&pcxt->estimator, esthnswarea);
+#ifdef MADV_HUGEPAGE
+	/* Leave room to start the graph on a huge page boundary */
+	if (huge_pages != HUGE_PAGES_OFF)
+		hugepageslack = HnswHugePageSize();
+#endif
+
+	shm_toc_estimate_chunk(&pcxt->estimator, esthnswarea + hugepageslack);
 	shm_toc_estimate_keys(&pcxt->estimator, 2);
 
 	/* Finally, estimate PARALLEL_KEY_QUERY_TEXT space */
@@ -977,9 +1129,21 @@ HnswBeginParallel(HnswBuildState * buildstate, bool isconcurrent, int request)
 								  ParallelTableScanFromHnswShared(hnswshared),
 								  snapshot);
 
-	hnswarea = (char *) shm_toc_allocate(pcxt->toc, esthnswarea);
+	hnswarea = (char *) shm_toc_allocate(pcxt->toc, esthnswarea + hugepageslack);
+
+	/* Start on a huge page boundary within the segment */
+	if (hugepageslack > 0)
+	{
+		char	   *base = dsm_segment_address(pcxt->seg);
+		Size		offset = hnswarea - base;
+
+		hnswarea += TYPEALIGN(hugepageslack, offset) - offset;
+	}
+
 	/* Report less than allocated so never fails */
 	InitGraph(&hnswshared->graphData, hnswarea, esthnswarea - 1024 * 1024);
+	NumaInterleaveMemory(hnswarea, hnswshared->graphData.memoryTotal);
+	HnswAdviseHugePages(hnswarea, hnswshared->graphData.memoryTotal);
 
 	/*
 	 * Avoid base address for relptr for Postgres < 14.5
@@ -1090,7 +1254,16 @@ BuildGraph(HnswBuildState * buildstate)
 
 	/* End parallel build */
 	if (buildstate->hnswleader)
+	{
+		/* Reading smaps is not free */
+#if PG_VERSION_NUM >= 140000
+		if (message_level_is_interesting(DEBUG1))
+#else
+		if (log_min_messages <= DEBUG1 || client_min_messages <= DEBUG1)
+#endif
+			HnswReportPageSize(buildstate->hnswleader->hnswarea, buildstate->graph->memoryUsed);
 		HnswEndParallel(buildstate->hnswleader);
+	}
 }
 
 /*
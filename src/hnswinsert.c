@@ -40,7 +40,7 @@ GetInsertPage(Relation index)
  * Check for a free offset
  */
 static bool
-HnswFreeOffset(Relation index, Buffer buf, Page page, HnswElement element, Size etupSize, Size ntupSize, Buffer *nbuf, Page *npage, OffsetNumber *freeOffno, OffsetNumber *freeNeighborOffno, BlockNumber *newInsertPage, uint8 *tupleVersion)
+HnswFreeOffset(Relation index, Buffer buf, Page page, HnswElement element, Size etupSize, Size ntupSize, bool colocate, Buffer *nbuf, Page *npage, OffsetNumber *freeOffno, OffsetNumber *freeNeighborOffno, BlockNumber *newInsertPage, BlockNumber *splitPage, uint8 *tupleVersion)
 {
 	OffsetNumber offno;
 	OffsetNumber maxoffno = PageGetMaxOffsetNumber(page);
@@ -66,6 +66,19 @@ HnswFreeOffset(Relation index, Buffer buf, Page page, HnswElement element, Size
 			if (!BlockNumberIsValid(*newInsertPage))
 				*newInsertPage = elementPage;
 
+			/*
+			 * Do not split an element from its neighbors when both can fit
+			 * on one page, since that costs an extra buffer access per hop.
+			 * Remember the page so the slot can still be used if there is no
+			 * other space.
+			 */
+			if (colocate && neighborPage != elementPage)
+			{
+				if (!BlockNumberIsValid(*splitPage))
+					*splitPage = elementPage;
+				continue;
+			}
+
 			if (neighborPage == elementPage)
 			{
 				*nbuf = buf;
@@ -158,6 +171,10 @@ AddElementOnDisk(Relation index, HnswElement e, int m, BlockNumber insertPage, B
 	OffsetNumber freeOffno = InvalidOffsetNumber;
 	OffsetNumber freeNeighborOffno = InvalidOffsetNumber;
 	BlockNumber newInsertPage = InvalidBlockNumber;
+	BlockNumber splitPage = InvalidBlockNumber;
+	BlockNumber nblocks = RelationGetNumberOfBlocks(index);
+	int			skippedPages = 0;
+	bool		colocate;
 	uint8		tupleVersion;
 	char	   *base = NULL;
 
@@ -167,6 +184,7 @@ AddElementOnDisk(Relation index, HnswElement e, int m, BlockNumber insertPage, B
 	combinedSize = etupSize + ntupSize + sizeof(ItemIdData);
 	maxSize = HNSW_MAX_SIZE;
 	minCombinedSize = etupSize + HNSW_NEIGHBOR_TUPLE_SIZE(0, m) + sizeof(ItemIdData);
+	colocate = combinedSize <= maxSize;
 
 	/* Prepare element tuple */
 	etup = palloc0(etupSize);
@@ -180,7 +198,31 @@ AddElementOnDisk(Relation index, HnswElement e, int m, BlockNumber insertPage, B
 	for (;;)
 	{
 		buf = ReadBuffer(index, currentPage);
-		LockBuffer(buf, BUFFER_LOCK_EXCLUSIVE);
+
+		/*
+		 * Skip a page locked by another backend if there are pages after it,
+		 * so concurrent inserts do not all wait on the same buffer. Every
+		 * block after the metapage is a graph page, so it is fine to continue
+		 * with the next block. The lock may also be held in share mode by a
+		 * scan, so only skip a few pages before waiting. The last page is
+		 * never skipped since extending the index requires its lock.
+		 */
+		if (!building && skippedPages < HNSW_MAX_SKIPPED_PAGES && currentPage + 1 < nblocks)
+		{
+			if (!ConditionalLockBuffer(buf))
+			{
+				/* Free space is unknown, so keep the insert page from passing it */
+				if (!BlockNumberIsValid(newInsertPage))
+					newInsertPage = currentPage;
+
+				ReleaseBuffer(buf);
+				currentPage++;
+				skippedPages++;
+				continue;
+			}
+		}
+		else
+			LockBuffer(buf, BUFFER_LOCK_EXCLUSIVE);
 
 		if (building)
 		{
@@ -208,7 +250,7 @@ AddElementOnDisk(Relation index, HnswElement e, int m, BlockNumber insertPage, B
 		}
 
 		/* Next, try space from a deleted element */
-		if (HnswFreeOffset(index, buf, page, e, etupSize, ntupSize, &nbuf, &npage, &freeOffno, &freeNeighborOffno, &newInsertPage, &tupleVersion))
+		if (HnswFreeOffset(index, buf, page, e, etupSize, ntupSize, colocate, &nbuf, &npage, &freeOffno, &freeNeighborOffno, &newInsertPage, &splitPage, &tupleVersion))
 		{
 			if (nbuf != buf)
 			{
@@ -235,6 +277,17 @@ AddElementOnDisk(Relation index, HnswElement e, int m, BlockNumber insertPage, B
 
 		currentPage = HnswPageGetOpaque(page)->nextblkno;
 
+		/*
+		 * Fall back to slots split from their neighbors before extending the
+		 * index, so they do not go unused when deleted elements were large
+		 */
+		if (!BlockNumberIsValid(currentPage) && BlockNumberIsValid(splitPage))
+		{
+			currentPage = splitPage;
+			splitPage = InvalidBlockNumber;
+			colocate = false;
+		}
+
 		if (BlockNumberIsValid(currentPage))
 		{
 			/* Move to next page */
@@ -714,8 +767,13 @@ HnswInsertTupleOnDisk(Relation index, HnswSupport * support, Datum value, ItemPo
 	element = HnswInitElement(base, heaptid, m, HnswGetMl(m), HnswGetMaxLevel(m), NULL);
 	HnswPtrStore(base, element->value, DatumGetPointer(value));
 
-	/* Prevent concurrent inserts when likely updating entry point */
-	if (entryPoint == NULL || element->level > entryPoint->level)
+	/*
+	 * Prevent concurrent inserts into an empty graph, since elements added
+	 * without an entry point would not be connected. Promoting the entry
+	 * point does not need the exclusive lock, since it happens after the
+	 * element is added and only if its level is still greater.
+	 */
+	if (entryPoint == NULL)
 	{
 		/* Release shared lock */
 		UnlockPage(index, HNSW_UPDATE_LOCK, lockmode);
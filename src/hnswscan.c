@@ -8,6 +8,124 @@
 #include "utils/float.h"
 #include "utils/memutils.h"
 
+/*
+ * Compare candidate distances with pointer tie-breaker
+ */
+static int
+CompareScanItems(const ListCell *a, const ListCell *b)
+{
+	HnswSearchCandidate *sca = lfirst(a);
+	HnswSearchCandidate *scb = lfirst(b);
+
+	if (sca->distance < scb->distance)
+		return 1;
+
+	if (sca->distance > scb->distance)
+		return -1;
+
+	if (HnswPtrPointer(sca->element) < HnswPtrPointer(scb->element))
+		return 1;
+
+	if (HnswPtrPointer(sca->element) > HnswPtrPointer(scb->element))
+		return -1;
+
+	return 0;
+}
+
+/*
+ * Compare re-scored candidate distances
+ */
+static int
+CompareNearestRescoredCandidates(const pairingheap_node *a, const pairingheap_node *b, void *arg)
+{
+	if (HnswGetSearchCandidateConst(c_node, a)->distance < HnswGetSearchCandidateConst(c_node, b)->distance)
+		return 1;
+
+	if (HnswGetSearchCandidateConst(c_node, a)->distance > HnswGetSearchCandidateConst(c_node, b)->distance)
+		return -1;
+
+	return 0;
+}
+
+/*
+ * Get re-scored candidates that no discarded candidate can precede
+ *
+ * Distances with leading dimensions are a lower bound for L2 and L1
+ * distance, so the order is exact for them
+ */
+static List *
+GetRescoredItems(HnswScanOpaque so)
+{
+	List	   *w = NIL;
+	double		maxDistance = get_float8_infinity();
+
+	if (so->discarded != NULL && !pairingheap_is_empty(so->discarded))
+		maxDistance = HnswGetSearchCandidate(w_node, pairingheap_first(so->discarded))->distance;
+
+	while (!pairingheap_is_empty(so->rescored))
+	{
+		HnswSearchCandidate *sc = HnswGetSearchCandidate(c_node, pairingheap_first(so->rescored));
+
+		if (sc->distance > maxDistance)
+			break;
+
+		pairingheap_remove_first(so->rescored);
+		w = lappend(w, sc);
+	}
+
+	/* Nearest last */
+	list_sort(w, CompareScanItems);
+
+	return w;
+}
+
+/*
+ * Re-score candidates found with leading dimensions using all dimensions
+ */
+static List *
+RescoreScanItems(IndexScanDesc scan, List *w)
+{
+	HnswScanOpaque so = (HnswScanOpaque) scan->opaque;
+	char	   *base = NULL;
+	ListCell   *lc;
+
+	if (so->support.prefixDistance == NULL || DatumGetPointer(so->q.value) == NULL)
+		return w;
+
+	foreach(lc, w)
+	{
+		HnswSearchCandidate *sc = lfirst(lc);
+
+		sc->distance = HnswGetFullDistance(HnswPtrAccess(base, sc->element), &so->q, scan->indexRelation, &so->support);
+	}
+
+	if (hnsw_iterative_scan == HNSW_ITERATIVE_SCAN_OFF)
+	{
+		/* Nearest last */
+		list_sort(w, CompareScanItems);
+
+		return w;
+	}
+
+	/*
+	 * A candidate in a later batch can be nearer with all dimensions, so
+	 * hold candidates across batches and return them in order
+	 */
+	if (so->rescored == NULL)
+		so->rescored = pairingheap_allocate(CompareNearestRescoredCandidates, NULL);
+
+	foreach(lc, w)
+	{
+		HnswSearchCandidate *sc = lfirst(lc);
+
+		pairingheap_add(so->rescored, &sc->c_node);
+	}
+
+	list_free(w);
+
+	return GetRescoredItems(so);
+}
+
 /*
  * Algorithm 5 from paper
  */
@@ -41,7 +159,9 @@ GetScanItems(IndexScanDesc scan, Datum value)
 		ep = w;
 	}
 
-	return HnswSearchLayer(base, q, ep, hnsw_ef_search, 0, index, support, m, false, NULL, &so->v, hnsw_iterative_scan != HNSW_ITERATIVE_SCAN_OFF ? &so->discarded : NULL, true, &so->tuples);
+	w = HnswSearchLayer(base, q, ep, HnswGetEfSearch(index), 0, index, support, m, false, NULL, &so->v, hnsw_iterative_scan != HNSW_ITERATIVE_SCAN_OFF ? &so->discarded : NULL, true, &so->tuples);
+
+	return RescoreScanItems(scan, w);
 }
 
 /*
@@ -53,11 +173,13 @@ ResumeScanItems(IndexScanDesc scan)
 	HnswScanOpaque so = (HnswScanOpaque) scan->opaque;
 	Relation	index = scan->indexRelation;
 	List	   *ep = NIL;
+	List	   *w;
 	char	   *base = NULL;
-	int			batch_size = hnsw_ef_search;
+	int			batch_size = HnswGetEfSearch(index);
 
+	/* Return held candidates */
 	if (pairingheap_is_empty(so->discarded))
-		return NIL;
+		return RescoreScanItems(scan, NIL);
 
 	/* Get next batch of candidates */
 	for (int i = 0; i < batch_size; i++)
@@ -72,7 +194,9 @@ ResumeScanItems(IndexScanDesc scan)
 		ep = lappend(ep, sc);
 	}
 
-	return HnswSearchLayer(base, &so->q, ep, batch_size, 0, index, &so->support, so->m, false, NULL, &so->v, &so->discarded, false, &so->tuples);
+	w = HnswSearchLayer(base, &so->q, ep, batch_size, 0, index, &so->support, so->m, false, NULL, &so->v, &so->discarded, false, &so->tuples);
+
+	return RescoreScanItems(scan, w);
 }
 
 /*
@@ -97,6 +221,22 @@ GetScanValue(IndexScanDesc scan)
 		/* Normalize if needed */
 		if (so->support.normprocinfo != NULL)
 			value = HnswNormValue(so->typeInfo, so->support.collation, value);
+
+		/* Distance functions cannot check after projection or with prefixes */
+		if (so->support.projectDimensions > 0 || so->support.prefixDistance != NULL)
+		{
+			int			dimensions = TupleDescAttr(scan->indexRelation->rd_att, 0)->atttypmod;
+			Vector	   *vec = DatumGetVector(value);
+
+			if (vec->dim != dimensions)
+				ereport(ERROR,
+						(errcode(ERRCODE_DATA_EXCEPTION),
+						 errmsg("different vector dimensions %d and %d", dimensions, vec->dim)));
+		}
+
+		/* Project like index values */
+		if (so->support.projectDimensions > 0)
+			value = HnswProjectValue(value, so->support.projectDimensions);
 	}
 
 	return value;
@@ -161,6 +301,7 @@ hnswrescan(IndexScanDesc scan, ScanKey keys, int nkeys, ScanKey orderbys, int no
 	/* v and discarded are allocated in tmpCtx */
 	so->v.tids = NULL;
 	so->discarded = NULL;
+	so->rescored = NULL;
 	so->tuples = 0;
 	so->previousDistance = -get_float8_infinity();
 	MemoryContextReset(so->tmpCtx);
@@ -247,11 +388,19 @@ hnswgettuple(IndexScanDesc scan, ScanDirection dir)
 			/* Reached max number of tuples or memory limit */
 			if (so->tuples >= hnsw_max_scan_tuples || MemoryContextMemAllocated(so->tmpCtx, false) > so->maxMemory)
 			{
-				if (pairingheap_is_empty(so->discarded))
+				/* Return held candidates first */
+				if (so->rescored != NULL && !pairingheap_is_empty(so->rescored))
+				{
+					while (!pairingheap_is_empty(so->rescored))
+						so->w = lcons(HnswGetSearchCandidate(c_node, pairingheap_remove_first(so->rescored)), so->w);
+				}
+				else if (pairingheap_is_empty(so->discarded))
 					break;
-
-				/* Return remaining tuples */
-				so->w = lappend(so->w, HnswGetSearchCandidate(w_node, pairingheap_remove_first(so->discarded)));
+				else
+				{
+					/* Return remaining tuples */
+					so->w = lappend(so->w, HnswGetSearchCandidate(w_node, pairingheap_remove_first(so->discarded)));
+				}
 			}
 			else
 			{
@@ -276,7 +425,13 @@ hnswgettuple(IndexScanDesc scan, ScanDirection dir)
 			}
 
 			if (list_length(so->w) == 0)
+			{
+				/* Held candidates wait for the next batch */
+				if (so->rescored != NULL && !pairingheap_is_empty(so->rescored))
+					continue;
+
 				break;
+			}
 		}
 
 		sc = llast(so->w);
@@ -3,11 +3,15 @@
 #include <math.h>
 
 #include "access/generic_xlog.h"
+#include "bf16utils.h"
+#include "bitvec.h"
 #include "catalog/pg_type.h"
 #include "catalog/pg_type_d.h"
 #include "common/hashfn.h"
 #include "fmgr.h"
+#include "halfutils.h"
 #include "hnsw.h"
+#include "int8vec.h"
 #include "lib/pairingheap.h"
 #include "sparsevec.h"
 #include "storage/bufmgr.h"
@@ -132,6 +136,120 @@ HnswGetEfConstruction(Relation index)
 	return HNSW_DEFAULT_EF_CONSTRUCTION;
 }
 
+/*
+ * Get the pruning factor
+ */
+double
+HnswGetAlpha(Relation index)
+{
+	HnswOptions *opts = (HnswOptions *) index->rd_options;
+
+	if (opts)
+		return opts->alpha;
+
+	return HNSW_DEFAULT_ALPHA;
+}
+
+/*
+ * Get the size of the dynamic candidate list for search
+ */
+int
+HnswGetEfSearch(Relation index)
+{
+	HnswOptions *opts = (HnswOptions *) index->rd_options;
+
+	/* Index option is the minimum */
+	if (opts && opts->efSearch > hnsw_ef_search)
+		return opts->efSearch;
+
+	return hnsw_ef_search;
+}
+
+/*
+ * Get the number of dimensions to keep after projection (zero if disabled)
+ */
+int
+HnswGetProjectDimensions(Relation index)
+{
+	HnswOptions *opts = (HnswOptions *) index->rd_options;
+
+	if (opts)
+		return opts->projectDimensions;
+
+	return 0;
+}
+
+/*
+ * Get the number of leading dimensions for traversal (zero if disabled)
+ */
+int
+HnswGetPrefixDimensions(Relation index)
+{
+	HnswOptions *opts = (HnswOptions *) index->rd_options;
+
+	if (opts)
+		return opts->prefixDimensions;
+
+	return 0;
+}
+
+PGDLLEXPORT Datum vector_l2_squared_distance(PG_FUNCTION_ARGS);
+PGDLLEXPORT Datum halfvec_l2_squared_distance(PG_FUNCTION_ARGS);
+PGDLLEXPORT Datum sparsevec_l2_squared_distance(PG_FUNCTION_ARGS);
+PGDLLEXPORT Datum bf16vec_l2_squared_distance(PG_FUNCTION_ARGS);
+PGDLLEXPORT Datum int8vec_l2_squared_distance(PG_FUNCTION_ARGS);
+PGDLLEXPORT Datum vector_negative_inner_product(PG_FUNCTION_ARGS);
+PGDLLEXPORT Datum l1_distance(PG_FUNCTION_ARGS);
+
+/*
+ * Check if the distance function returns squared L2 distance
+ */
+static bool
+HnswIsL2Squared(HnswSupport * support)
+{
+	PGFunction	fn = support->procinfo->fn_addr;
+
+	return fn == vector_l2_squared_distance ||
+		fn == halfvec_l2_squared_distance ||
+		fn == sparsevec_l2_squared_distance ||
+		fn == bf16vec_l2_squared_distance ||
+		fn == int8vec_l2_squared_distance;
+}
+
+static double
+PrefixL2SquaredDistance(int dim, float *ax, float *bx)
+{
+	return VectorL2SquaredDistance(dim, ax, bx);
+}
+
+static double
+PrefixNegativeInnerProduct(int dim, float *ax, float *bx)
+{
+	return -VectorInnerProduct(dim, ax, bx);
+}
+
+static double
+PrefixL1Distance(int dim, float *ax, float *bx)
+{
+	return VectorL1Distance(dim, ax, bx);
+}
+
+/*
+ * Set the prefix equivalent of the distance function (vector only)
+ */
+static void
+HnswInitPrefixDistance(HnswSupport * support)
+{
+	PGFunction	fn = support->procinfo->fn_addr;
+
+	if (fn == vector_l2_squared_distance)
+		support->prefixDistance = PrefixL2SquaredDistance;
+	else if (fn == vector_negative_inner_product)
+		support->prefixDistance = PrefixNegativeInnerProduct;
+	else if (fn == l1_distance)
+		support->prefixDistance = PrefixL1Distance;
+}
+
 /*
  * Get proc
  */
@@ -145,14 +263,62 @@ HnswOptionalProcInfo(Relation index, uint16 procnum)
 }
 
 /*
- * Init support functions
+ * Init support functions for the specified projection and prefix
  */
 void
-HnswInitSupport(HnswSupport * support, Relation index)
+HnswInitBuildSupport(HnswSupport * support, Relation index, int projectDimensions, int prefixDimensions)
 {
+	int			dimensions = projectDimensions > 0 ? projectDimensions : TupleDescAttr(index->rd_att, 0)->atttypmod;
+
 	support->procinfo = index_getprocinfo(index, 1, HNSW_DISTANCE_PROC);
 	support->collation = index->rd_indcollation[0];
 	support->normprocinfo = HnswOptionalProcInfo(index, HNSW_NORM_PROC);
+	support->alpha = HnswGetAlpha(index);
+	support->projectDimensions = projectDimensions;
+	support->prefixDimensions = prefixDimensions;
+	support->prefixDistance = NULL;
+
+	/* Prefixes must be shorter than indexed values (build checks this) */
+	if (support->prefixDimensions >= dimensions)
+		support->prefixDimensions = 0;
+
+	/* Alpha applies to distances, so square it for squared distances */
+	if (HnswIsL2Squared(support))
+		support->alpha *= support->alpha;
+
+	if (support->prefixDimensions > 0)
+		HnswInitPrefixDistance(support);
+}
+
+/*
+ * Init support functions for a built index
+ *
+ * Use the projection and prefix from the metapage since the reloptions can
+ * change without rebuilding the index
+ */
+void
+HnswInitSupport(HnswSupport * support, Relation index)
+{
+	Buffer		buf;
+	Page		page;
+	HnswMetaPage metap;
+	int			projectDimensions;
+	int			prefixDimensions;
+
+	buf = ReadBuffer(index, HNSW_METAPAGE_BLKNO);
+	LockBuffer(buf, BUFFER_LOCK_SHARE);
+	page = BufferGetPage(buf);
+	metap = HnswPageGetMeta(page);
+
+	if (unlikely(metap->magicNumber != HNSW_MAGIC_NUMBER))
+		elog(ERROR, "hnsw index is not valid");
+
+	projectDimensions = metap->projectDimensions;
+	prefixDimensions = metap->prefixDimensions;
+
+	UnlockReleaseBuffer(buf);
+
+	HnswInitBuildSupport(support, index, projectDimensions, prefixDimensions);
 }
 
 /*
@@ -173,6 +339,78 @@ HnswCheckNorm(HnswSupport * support, Datum value)
 	return DatumGetFloat8(FunctionCall1Coll(support->normprocinfo, support->collation, value)) > 0;
 }
 
+/*
+ * Apply a random sign flip and an orthonormal Walsh-Hadamard transform
+ *
+ * Signs come from a fixed hash so every backend produces the same rotation
+ * without storing a matrix in the index
+ */
+static void
+RandomHadamardRotate(float *x, int n, uint32 round)
+{
+	float		scale = 1 / sqrtf(n);
+
+	for (int i = 0; i < n; i++)
+	{
+		if (murmurhash32((round << 16) | i) & 1)
+			x[i] = -x[i];
+	}
+
+	for (int h = 1; h < n; h *= 2)
+	{
+		for (int i = 0; i < n; i += h * 2)
+		{
+			for (int j = i; j < i + h; j++)
+			{
+				float		a = x[j];
+				float		b = x[j + h];
+
+				x[j] = a + b;
+				x[j + h] = a - b;
+			}
+		}
+	}
+
+	for (int i = 0; i < n; i++)
+		x[i] *= scale;
+}
+
+/*
+ * Project a vector onto fewer dimensions
+ *
+ * Rotates with a randomized Hadamard transform (padding to a power of two)
+ * and keeps the leading dimensions. The rotation preserves distances and
+ * spreads energy evenly, so truncation scales distances by roughly the same
+ * factor for every pair.
+ */
+Datum
+HnswProjectValue(Datum value, int dimensions)
+{
+	Vector	   *vec = DatumGetVector(value);
+	Vector	   *result;
+	float	   *x;
+	int			n = 1;
+
+	while (n < vec->dim)
+		n *= 2;
+
+	x = palloc0(sizeof(float) * n);
+	for (int i = 0; i < vec->dim; i++)
+		x[i] = vec->x[i];
+
+	/* Two rounds mix sparse inputs across all dimensions */
+	for (uint32 round = 0; round < 2; round++)
+		RandomHadamardRotate(x, n, round);
+
+	result = InitVector(dimensions);
+	for (int i = 0; i < dimensions; i++)
+		result->x[i] = x[i];
+
+	pfree(x);
+
+	return PointerGetDatum(result);
+}
+
 /*
  * New buffer
  */
@@ -325,6 +563,52 @@ HnswGetMetaPageInfo(Relation index, int *m, HnswElement * entryPoint)
 	UnlockReleaseBuffer(buf);
 }
 
+/*
+ * Get m and the scaling factor for cost estimation
+ */
+void
+HnswGetMetaPageCostInfo(Relation index, int *m, double *scalingFactor)
+{
+	Buffer		buf;
+	Page		page;
+	HnswMetaPage metap;
+
+	buf = ReadBuffer(index, HNSW_METAPAGE_BLKNO);
+	LockBuffer(buf, BUFFER_LOCK_SHARE);
+	page = BufferGetPage(buf);
+	metap = HnswPageGetMeta(page);
+
+	if (unlikely(metap->magicNumber != HNSW_MAGIC_NUMBER))
+		elog(ERROR, "hnsw index is not valid");
+
+	*m = metap->m;
+
+	/* Zero for indexes created before this field was added */
+	if (metap->scalingFactor > 0)
+		*scalingFactor = metap->scalingFactor;
+	else
+		*scalingFactor = HNSW_DEFAULT_SCALING_FACTOR;
+
+	UnlockReleaseBuffer(buf);
+}
+
+/*
+ * Estimate the number of tuples visited by a scan
+ *
+ * tuples = entryLevel * m + layer0TuplesMax * layer0Selectivity
+ *
+ * See hnswcostestimate for details
+ */
+double
+HnswEstimateScanTuples(double tuples, int m, int efSearch, double scalingFactor)
+{
+	int			entryLevel = (int) (log(tuples) * HnswGetMl(m));
+	int			layer0TuplesMax = HnswGetLayerM(m, 0) * efSearch;
+	double		layer0Selectivity = scalingFactor * log(tuples) / (log(m) * (1 + log(efSearch)));
+
+	return entryLevel * m + layer0TuplesMax * layer0Selectivity;
+}
+
 /*
  * Get the entry point
  */
@@ -420,6 +704,10 @@ HnswFormIndexValue(Datum *out, Datum *values, bool *isnull, const HnswTypeInfo *
 		value = HnswNormValue(typeInfo, support->collation, value);
 	}
 
+	/* Project after normalizing since rotation preserves norms */
+	if (support->projectDimensions > 0)
+		value = HnswProjectValue(value, support->projectDimensions);
+
 	*out = value;
 
 	return true;
@@ -522,6 +810,10 @@ HnswLoadElementFromTuple(HnswElement element, HnswElementTuple etup, bool loadHe
 static inline double
 HnswGetDistance(Datum a, Datum b, HnswSupport * support)
 {
+	/* Use leading dimensions in place */
+	if (support->prefixDistance != NULL)
+		return support->prefixDistance(support->prefixDimensions, DatumGetVector(a)->x, DatumGetVector(b)->x);
+
 	return DatumGetFloat8(FunctionCall2Coll(support->procinfo, support->collation, a, b));
 }
 
@@ -574,6 +866,32 @@ HnswLoadElement(HnswElement element, double *distance, HnswQuery * q, Relation i
 	HnswLoadElementImpl(element->blkno, element->offno, distance, q, index, support, loadVec, maxDistance, &element);
 }
 
+/*
+ * Get the distance for an element using all dimensions
+ */
+double
+HnswGetFullDistance(HnswElement element, HnswQuery * q, Relation index, HnswSupport * support)
+{
+	Buffer		buf;
+	Page		page;
+	HnswElementTuple etup;
+	double		distance;
+
+	buf = ReadBuffer(index, element->blkno);
+	LockBuffer(buf, BUFFER_LOCK_SHARE);
+	page = BufferGetPage(buf);
+
+	etup = (HnswElementTuple) PageGetItem(page, PageGetItemId(page, element->offno));
+
+	Assert(HnswIsElementTuple(etup));
+
+	distance = DatumGetFloat8(FunctionCall2Coll(support->procinfo, support->collation, q->value, PointerGetDatum(&etup->data)));
+
+	UnlockReleaseBuffer(buf);
+
+	return distance;
+}
+
 /*
  * Get the distance for an element
  */
@@ -1044,6 +1362,13 @@ CheckElementCloser(char *base, HnswCandidate * e, List *r, HnswSupport * support
 		Datum		riValue = HnswGetValue(base, riElement);
 		float		distance = HnswGetDistance(eValue, riValue, support);
 
+		/*
+		 * Alpha > 1 keeps longer edges like Vamana. Only scale positive
+		 * distances so negative inner product does not prune more.
+		 */
+		if (distance > 0)
+			distance *= support->alpha;
+
 		if (distance <= e->distance)
 			return false;
 	}
@@ -1351,8 +1676,174 @@ HnswFindElementNeighbors(char *base, HnswElement element, HnswElement entryPoint
 
 PGDLLEXPORT Datum l2_normalize(PG_FUNCTION_ARGS);
 PGDLLEXPORT Datum halfvec_l2_normalize(PG_FUNCTION_ARGS);
+PGDLLEXPORT Datum bf16vec_l2_normalize(PG_FUNCTION_ARGS);
 PGDLLEXPORT Datum sparsevec_l2_normalize(PG_FUNCTION_ARGS);
 
+/*
+ * Move a vector toward another by a fraction of the difference
+ */
+static Datum
+VectorInterpolate(Pointer a, Pointer b, float t)
+{
+	Vector	   *va = (Vector *) a;
+	Vector	   *vb = (Vector *) b;
+	Vector	   *result;
+
+	if (va->dim != vb->dim)
+		return PointerGetDatum(a);
+
+	result = InitVector(va->dim);
+	for (int i = 0; i < va->dim; i++)
+		result->x[i] = va->x[i] + (vb->x[i] - va->x[i]) * t;
+
+	return PointerGetDatum(result);
+}
+
+static Datum
+HalfvecInterpolate(Pointer a, Pointer b, float t)
+{
+	HalfVector *va = (HalfVector *) a;
+	HalfVector *vb = (HalfVector *) b;
+	HalfVector *result;
+
+	if (va->dim != vb->dim)
+		return PointerGetDatum(a);
+
+	result = InitHalfVector(va->dim);
+	for (int i = 0; i < va->dim; i++)
+	{
+		float		ax = HalfToFloat4(va->x[i]);
+
+		result->x[i] = Float4ToHalfUnchecked(ax + (HalfToFloat4(vb->x[i]) - ax) * t);
+	}
+
+	return PointerGetDatum(result);
+}
+
+static Datum
+Bf16vecInterpolate(Pointer a, Pointer b, float t)
+{
+	Bf16Vector *va = (Bf16Vector *) a;
+	Bf16Vector *vb = (Bf16Vector *) b;
+	Bf16Vector *result;
+
+	if (va->dim != vb->dim)
+		return PointerGetDatum(a);
+
+	result = InitBf16Vector(va->dim);
+	for (int i = 0; i < va->dim; i++)
+	{
+		float		ax = Bf16ToFloat4(va->x[i]);
+
+		result->x[i] = Float4ToBf16Unchecked(ax + (Bf16ToFloat4(vb->x[i]) - ax) * t);
+	}
+
+	return PointerGetDatum(result);
+}
+
+static Datum
+Int8vecInterpolate(Pointer a, Pointer b, float t)
+{
+	Int8Vector *va = (Int8Vector *) a;
+	Int8Vector *vb = (Int8Vector *) b;
+	Int8Vector *result;
+
+	if (va->dim != vb->dim)
+		return PointerGetDatum(a);
+
+	/* Stays between the two values, so cannot overflow */
+	result = InitInt8Vector(va->dim);
+	for (int i = 0; i < va->dim; i++)
+		result->x[i] = (int8) rintf(va->x[i] + (vb->x[i] - va->x[i]) * t);
+
+	return PointerGetDatum(result);
+}
+
+static Datum
+SparsevecInterpolate(Pointer a, Pointer b, float t)
+{
+	SparseVector *va = (SparseVector *) a;
+	SparseVector *vb = (SparseVector *) b;
+	float	   *ax = SPARSEVEC_VALUES(va);
+	float	   *bx = SPARSEVEC_VALUES(vb);
+	SparseVector *result;
+	float	   *rx;
+	int			nnz = 0;
+	int			i = 0;
+	int			j = 0;
+
+	if (va->dim != vb->dim)
+		return PointerGetDatum(a);
+
+	/* Indices are sorted, so merge them */
+	result = InitSparseVector(va->dim, va->nnz + vb->nnz);
+	rx = SPARSEVEC_VALUES(result);
+	while (i < va->nnz || j < vb->nnz)
+	{
+		int			index;
+		float		x = 0;
+		float		y = 0;
+
+		if (j == vb->nnz || (i < va->nnz && va->indices[i] < vb->indices[j]))
+		{
+			index = va->indices[i];
+			x = ax[i++];
+		}
+		else if (i == va->nnz || vb->indices[j] < va->indices[i])
+		{
+			index = vb->indices[j];
+			y = bx[j++];
+		}
+		else
+		{
+			index = va->indices[i];
+			x = ax[i++];
+			y = bx[j++];
+		}
+
+		/* Skip values that cancel out */
+		if (x + (y - x) * t != 0)
+		{
+			result->indices[nnz] = index;
+			rx[nnz] = x + (y - x) * t;
+			nnz++;
+		}
+	}
+
+	/* Values come after indices, so move them to the final position */
+	result->nnz = nnz;
+	memmove(SPARSEVEC_VALUES(result), rx, nnz * sizeof(float));
+	SET_VARSIZE(result, SPARSEVEC_SIZE(nnz));
+
+	return PointerGetDatum(result);
+}
+
+static Datum
+BitInterpolate(Pointer a, Pointer b, float t)
+{
+	VarBit	   *va = (VarBit *) a;
+	VarBit	   *vb = (VarBit *) b;
+	VarBit	   *result;
+	unsigned char *rx;
+
+	if (VARBITLEN(va) != VARBITLEN(vb))
+		return PointerGetDatum(a);
+
+	/* Take each bit from the other value with probability t */
+	result = InitBitVector(VARBITLEN(va));
+	rx = VARBITS(result);
+	memcpy(rx, VARBITS(va), VARBITBYTES(va));
+	for (int i = 0; i < VARBITLEN(va); i++)
+	{
+		unsigned char mask = 1 << (7 - (i % 8));
+
+		if (RandomDouble() < t)
+			rx[i / 8] = (rx[i / 8] & ~mask) | (VARBITS(vb)[i / 8] & mask);
+	}
+
+	return PointerGetDatum(result);
+}
+
 static void
 SparsevecCheckValue(Pointer v)
 {
@@ -1377,7 +1868,8 @@ HnswGetTypeInfo(Relation index)
 		static const HnswTypeInfo typeInfo = {
 			.maxDimensions = HNSW_MAX_DIM,
 			.normalize = l2_normalize,
-			.checkValue = NULL
+			.checkValue = NULL,
+			.interpolate = VectorInterpolate
 		};
 
 		return (&typeInfo);
@@ -1393,7 +1885,36 @@ hnsw_halfvec_support(PG_FUNCTION_ARGS)
 	static const HnswTypeInfo typeInfo = {
 		.maxDimensions = HNSW_MAX_DIM * 2,
 		.normalize = halfvec_l2_normalize,
-		.checkValue = NULL
+		.checkValue = NULL,
+		.interpolate = HalfvecInterpolate
+	};
+
+	PG_RETURN_POINTER(&typeInfo);
+}
+
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(hnsw_bf16vec_support);
+Datum
+hnsw_bf16vec_support(PG_FUNCTION_ARGS)
+{
+	static const HnswTypeInfo typeInfo = {
+		.maxDimensions = HNSW_MAX_DIM * 2,
+		.normalize = bf16vec_l2_normalize,
+		.checkValue = NULL,
+		.interpolate = Bf16vecInterpolate
+	};
+
+	PG_RETURN_POINTER(&typeInfo);
+}
+
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(hnsw_int8vec_support);
+Datum
+hnsw_int8vec_support(PG_FUNCTION_ARGS)
+{
+	static const HnswTypeInfo typeInfo = {
+		.maxDimensions = HNSW_MAX_DIM * 4,
+		.normalize = NULL,
+		.checkValue = NULL,
+		.interpolate = Int8vecInterpolate
 	};
 
 	PG_RETURN_POINTER(&typeInfo);
@@ -1406,7 +1927,8 @@ hnsw_bit_support(PG_FUNCTION_ARGS)
 	static const HnswTypeInfo typeInfo = {
 		.maxDimensions = HNSW_MAX_DIM * 32,
 		.normalize = NULL,
-		.checkValue = NULL
+		.checkValue = NULL,
+		.interpolate = BitInterpolate
 	};
 
 	PG_RETURN_POINTER(&typeInfo);
@@ -1419,7 +1941,8 @@ hnsw_sparsevec_support(PG_FUNCTION_ARGS)
 	static const HnswTypeInfo typeInfo = {
 		.maxDimensions = SPARSEVEC_MAX_DIM,
 		.normalize = sparsevec_l2_normalize,
-		.checkValue = SparsevecCheckValue
+		.checkValue = SparsevecCheckValue,
+		.interpolate = SparsevecInterpolate
 	};
 
 	PG_RETURN_POINTER(&typeInfo);
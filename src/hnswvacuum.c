@@ -7,6 +7,7 @@
 #include "hnsw.h"
 #include "storage/bufmgr.h"
 #include "storage/lmgr.h"
+#include "utils/datum.h"
 #include "utils/memutils.h"
 
 #if PG_VERSION_NUM >= 160000
@@ -615,6 +616,156 @@ FreeVacuumState(HnswVacuumState * vacuumstate)
 	MemoryContextDelete(vacuumstate->tmpCtx);
 }
 
+/*
+ * Get a value from an element on a page
+ */
+static bool
+GetSampleValue(Relation index, BlockNumber blkno, Datum *value)
+{
+	Buffer		buf;
+	Page		page;
+	OffsetNumber maxoffno;
+	bool		found = false;
+
+	buf = ReadBuffer(index, blkno);
+	LockBuffer(buf, BUFFER_LOCK_SHARE);
+	page = BufferGetPage(buf);
+	maxoffno = PageGetMaxOffsetNumber(page);
+
+	for (OffsetNumber offno = FirstOffsetNumber; offno <= maxoffno; offno = OffsetNumberNext(offno))
+	{
+		HnswElementTuple etup = (HnswElementTuple) PageGetItem(page, PageGetItemId(page, offno));
+
+		if (!HnswIsElementTuple(etup) || etup->deleted)
+			continue;
+
+		*value = datumCopy(PointerGetDatum(&etup->data), false, -1);
+		found = true;
+		break;
+	}
+
+	UnlockReleaseBuffer(buf);
+
+	return found;
+}
+
+/*
+ * Update the scaling factor in the metapage
+ */
+static void
+UpdateMetaPageScalingFactor(Relation index, float scalingFactor)
+{
+	Buffer		buf;
+	Page		page;
+	GenericXLogState *state;
+	HnswMetaPage metap;
+
+	buf = ReadBuffer(index, HNSW_METAPAGE_BLKNO);
+	LockBuffer(buf, BUFFER_LOCK_EXCLUSIVE);
+	state = GenericXLogStart(index);
+	page = GenericXLogRegisterBuffer(state, buf, 0);
+
+	metap = HnswPageGetMeta(page);
+	metap->scalingFactor = scalingFactor;
+
+	/* Extend for indexes created before this field was added */
+	((PageHeader) page)->pd_lower =
+		((char *) metap + sizeof(HnswMetaPageData)) - (char *) page;
+
+	GenericXLogFinish(state);
+	UnlockReleaseBuffer(buf);
+}
+
+/*
+ * Run sample searches to calibrate the scaling factor for cost estimation
+ */
+static void
+SampleSearches(Relation index, double reltuples)
+{
+	BlockNumber nblocks = RelationGetNumberOfBlocks(index);
+	const		HnswTypeInfo *typeInfo = HnswGetTypeInfo(index);
+	HnswSupport support;
+	HnswElement entryPoint;
+	int			m;
+	int			efSearch;
+	int			searches = 0;
+	int64		tuples = 0;
+	char	   *base = NULL;
+	MemoryContext sampleCtx;
+	MemoryContext oldCtx;
+
+	if (hnsw_analyze_searches == 0)
+		return;
+
+	/* Need enough tuples for the estimate to be meaningful */
+	if (reltuples < 2 || nblocks <= HNSW_HEAD_BLKNO)
+		return;
+
+	sampleCtx = AllocSetContextCreate(CurrentMemoryContext,
+									  "Hnsw analyze temporary context",
+									  ALLOCSET_DEFAULT_SIZES);
+	oldCtx = MemoryContextSwitchTo(sampleCtx);
+
+	HnswInitSupport(&support, index);
+
+	/* Prevent vacuum from removing elements during searches */
+	LockPage(index, HNSW_SCAN_LOCK, ShareLock);
+
+	HnswGetMetaPageInfo(index, &m, &entryPoint);
+	efSearch = HnswGetEfSearch(index);
+
+	for (int i = 0; i < hnsw_analyze_searches && entryPoint != NULL; i++)
+	{
+		BlockNumber blkno = HNSW_HEAD_BLKNO + (BlockNumber) (RandomDouble() * (nblocks - HNSW_HEAD_BLKNO));
+		BlockNumber otherBlkno = HNSW_HEAD_BLKNO + (BlockNumber) (RandomDouble() * (nblocks - HNSW_HEAD_BLKNO));
+		HnswQuery	q;
+		Datum		other;
+		List	   *ep;
+
+		/* Use elements in the index as queries */
+		if (!GetSampleValue(index, blkno, &q.value))
+			continue;
+
+		/*
+		 * An element is always found in its own neighborhood, which makes
+		 * searches cheaper than for real queries, so move it part of the way
+		 * toward another element
+		 */
+		if (typeInfo->interpolate != NULL && GetSampleValue(index, otherBlkno, &other))
+			q.value = typeInfo->interpolate(DatumGetPointer(q.value), DatumGetPointer(other), 0.1 + 0.2 * RandomDouble());
+
+		ep = list_make1(HnswEntryCandidate(base, entryPoint, &q, index, &support, false));
+
+		for (int lc = entryPoint->level; lc >= 1; lc--)
+			ep = HnswSearchLayer(base, &q, ep, 1, lc, index, &support, m, false, NULL, NULL, NULL, true, &tuples);
+
+		HnswSearchLayer(base, &q, ep, efSearch, 0, index, &support, m, false, NULL, NULL, NULL, true, &tuples);
+		searches++;
+	}
+
+	UnlockPage(index, HNSW_SCAN_LOCK, ShareLock);
+
+	MemoryContextSwitchTo(oldCtx);
+	MemoryContextDelete(sampleCtx);
+
+	if (searches > 0)
+	{
+		double		sampleTuples = (double) tuples / searches;
+		double		minTuples = HnswEstimateScanTuples(reltuples, m, efSearch, 0);
+		double		defaultTuples = HnswEstimateScanTuples(reltuples, m, efSearch, HNSW_DEFAULT_SCALING_FACTOR);
+		double		scalingFactor = HNSW_DEFAULT_SCALING_FACTOR;
+
+		/* Solve for the scaling factor that matches the sample */
+		if (defaultTuples > minTuples)
+			scalingFactor *= Max(sampleTuples - minTuples, 0) / (defaultTuples - minTuples);
+
+		/* Keep positive so zero means not sampled */
+		scalingFactor = Max(scalingFactor, 0.01);
+
+		UpdateMetaPageScalingFactor(index, scalingFactor);
+	}
+}
+
 /*
  * Bulk delete tuples from the index
  */
@@ -649,7 +800,10 @@ hnswvacuumcleanup(IndexVacuumInfo *info, IndexBulkDeleteResult *stats)
 	Relation	rel = info->index;
 
 	if (info->analyze_only)
+	{
+		SampleSearches(rel, info->num_heap_tuples);
 		return stats;
+	}
 
 	/* stats is NULL if ambulkdelete not called */
 	/* OK to return NULL if index not changed */
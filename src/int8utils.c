@@ -0,0 +1,430 @@
+#include "postgres.h"
+
+#include <stdlib.h>
+
+#include "int8utils.h"
+#include "int8vec.h"
+
+#ifdef INT8VEC_DISPATCH
+#include <immintrin.h>
+
+#if defined(USE__GET_CPUID)
+#include <cpuid.h>
+#else
+#include <intrin.h>
+#endif
+
+#ifdef _MSC_VER
+#define TARGET_AVX2
+#else
+#define TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+
+/* Requires compiler support for the intrinsics */
+#if defined(USE__GET_CPUID) && ((defined(__clang_major__) && __clang_major__ >= 6) || (!defined(__clang__) && defined(__GNUC__) && __GNUC__ >= 8))
+#define INT8VEC_AVX512_VNNI
+#define TARGET_AVX512_VNNI __attribute__((target("avx512f,avx512bw,avx512vnni")))
+#endif
+#endif
+
+int32		(*Int8vecL2SquaredDistance) (int dim, int8 * ax, int8 * bx);
+int32		(*Int8vecInnerProduct) (int dim, int8 * ax, int8 * bx);
+double		(*Int8vecCosineSimilarity) (int dim, int8 * ax, int8 * bx);
+int32		(*Int8vecL1Distance) (int dim, int8 * ax, int8 * bx);
+
+#ifdef INT8VEC_DISPATCH
+/*
+ * Sign-extend 16 int8 values to int16
+ *
+ * vpmaddubsw multiplies unsigned by signed bytes and saturates, so widen
+ * and use vpmaddwd instead to keep signed products exact
+ */
+TARGET_AVX2 static inline __m256i
+Int8x16ToInt16(int8 * x)
+{
+	return _mm256_cvtepi8_epi16(_mm_loadu_si128((__m128i *) x));
+}
+
+TARGET_AVX2 static inline int32
+SumInt32x8(__m256i v)
+{
+	__m128i		s = _mm_add_epi32(_mm256_castsi256_si128(v), _mm256_extracti128_si256(v, 1));
+
+	s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(1, 0, 3, 2)));
+	s = _mm_add_epi32(s, _mm_shuffle_epi32(s, _MM_SHUFFLE(2, 3, 0, 1)));
+	return _mm_cvtsi128_si32(s);
+}
+#endif
+
+static int32
+Int8vecL2SquaredDistanceDefault(int dim, int8 * ax, int8 * bx)
+{
+	int32		distance = 0;
+
+	/* Auto-vectorized */
+	for (int i = 0; i < dim; i++)
+	{
+		int32		diff = ax[i] - bx[i];
+
+		distance += diff * diff;
+	}
+
+	return distance;
+}
+
+#ifdef INT8VEC_DISPATCH
+TARGET_AVX2 static int32
+Int8vecL2SquaredDistanceAvx2(int dim, int8 * ax, int8 * bx)
+{
+	int32		distance;
+	int			i;
+	int			count = (dim / 16) * 16;
+	__m256i		dist = _mm256_setzero_si256();
+
+	for (i = 0; i < count; i += 16)
+	{
+		__m256i		diff = _mm256_sub_epi16(Int8x16ToInt16(ax + i), Int8x16ToInt16(bx + i));
+
+		dist = _mm256_add_epi32(dist, _mm256_madd_epi16(diff, diff));
+	}
+
+	distance = SumInt32x8(dist);
+
+	for (; i < dim; i++)
+	{
+		int32		diff = ax[i] - bx[i];
+
+		distance += diff * diff;
+	}
+
+	return distance;
+}
+#endif
+
+#ifdef INT8VEC_AVX512_VNNI
+TARGET_AVX512_VNNI static int32
+Int8vecL2SquaredDistanceAvx512Vnni(int dim, int8 * ax, int8 * bx)
+{
+	int32		distance;
+	int			i;
+	int			count = (dim / 32) * 32;
+	__m512i		dist = _mm512_setzero_si512();
+
+	for (i = 0; i < count; i += 32)
+	{
+		__m512i		axi = _mm512_cvtepi8_epi16(_mm256_loadu_si256((__m256i *) (ax + i)));
+		__m512i		bxi = _mm512_cvtepi8_epi16(_mm256_loadu_si256((__m256i *) (bx + i)));
+		__m512i		diff = _mm512_sub_epi16(axi, bxi);
+
+		dist = _mm512_dpwssd_epi32(dist, diff, diff);
+	}
+
+	distance = _mm512_reduce_add_epi32(dist);
+
+	for (; i < dim; i++)
+	{
+		int32		diff = ax[i] - bx[i];
+
+		distance += diff * diff;
+	}
+
+	return distance;
+}
+#endif
+
+static int32
+Int8vecInnerProductDefault(int dim, int8 * ax, int8 * bx)
+{
+	int32		distance = 0;
+
+	/* Auto-vectorized */
+	for (int i = 0; i < dim; i++)
+		distance += ax[i] * bx[i];
+
+	return distance;
+}
+
+#ifdef INT8VEC_DISPATCH
+TARGET_AVX2 static int32
+Int8vecInnerProductAvx2(int dim, int8 * ax, int8 * bx)
+{
+	int32		distance;
+	int			i;
+	int			count = (dim / 16) * 16;
+	__m256i		dist = _mm256_setzero_si256();
+
+	for (i = 0; i < count; i += 16)
+		dist = _mm256_add_epi32(dist, _mm256_madd_epi16(Int8x16ToInt16(ax + i), Int8x16ToInt16(bx + i)));
+
+	distance = SumInt32x8(dist);
+
+	for (; i < dim; i++)
+		distance += ax[i] * bx[i];
+
+	return distance;
+}
+#endif
+
+#ifdef INT8VEC_AVX512_VNNI
+TARGET_AVX512_VNNI static int32
+Int8vecInnerProductAvx512Vnni(int dim, int8 * ax, int8 * bx)
+{
+	int32		distance;
+	int			i;
+	int			count = (dim / 32) * 32;
+	__m512i		dist = _mm512_setzero_si512();
+
+	/* Multiplies pairs and accumulates in int32 */
+	for (i = 0; i < count; i += 32)
+	{
+		__m512i		axi = _mm512_cvtepi8_epi16(_mm256_loadu_si256((__m256i *) (ax + i)));
+		__m512i		bxi = _mm512_cvtepi8_epi16(_mm256_loadu_si256((__m256i *) (bx + i)));
+
+		dist = _mm512_dpwssd_epi32(dist, axi, bxi);
+	}
+
+	distance = _mm512_reduce_add_epi32(dist);
+
+	for (; i < dim; i++)
+		distance += ax[i] * bx[i];
+
+	return distance;
+}
+#endif
+
+static double
+Int8vecCosineSimilarityDefault(int dim, int8 * ax, int8 * bx)
+{
+	int32		similarity = 0;
+	int32		norma = 0;
+	int32		normb = 0;
+
+	/* Auto-vectorized */
+	for (int i = 0; i < dim; i++)
+	{
+		similarity += ax[i] * bx[i];
+		norma += ax[i] * ax[i];
+		normb += bx[i] * bx[i];
+	}
+
+	/* Use sqrt(a * b) over sqrt(a) * sqrt(b) */
+	return (double) similarity / sqrt((double) norma * (double) normb);
+}
+
+#ifdef INT8VEC_DISPATCH
+TARGET_AVX2 static double
+Int8vecCosineSimilarityAvx2(int dim, int8 * ax, int8 * bx)
+{
+	int32		similarity;
+	int32		norma;
+	int32		normb;
+	int			i;
+	int			count = (dim / 16) * 16;
+	__m256i		sim = _mm256_setzero_si256();
+	__m256i		na = _mm256_setzero_si256();
+	__m256i		nb = _mm256_setzero_si256();
+
+	for (i = 0; i < count; i += 16)
+	{
+		__m256i		axi = Int8x16ToInt16(ax + i);
+		__m256i		bxi = Int8x16ToInt16(bx + i);
+
+		sim = _mm256_add_epi32(sim, _mm256_madd_epi16(axi, bxi));
+		na = _mm256_add_epi32(na, _mm256_madd_epi16(axi, axi));
+		nb = _mm256_add_epi32(nb, _mm256_madd_epi16(bxi, bxi));
+	}
+
+	similarity = SumInt32x8(sim);
+	norma = SumInt32x8(na);
+	normb = SumInt32x8(nb);
+
+	for (; i < dim; i++)
+	{
+		similarity += ax[i] * bx[i];
+		norma += ax[i] * ax[i];
+		normb += bx[i] * bx[i];
+	}
+
+	/* Use sqrt(a * b) over sqrt(a) * sqrt(b) */
+	return (double) similarity / sqrt((double) norma * (double) normb);
+}
+#endif
+
+#ifdef INT8VEC_AVX512_VNNI
+TARGET_AVX512_VNNI static double
+Int8vecCosineSimilarityAvx512Vnni(int dim, int8 * ax, int8 * bx)
+{
+	int32		similarity;
+	int32		norma;
+	int32		normb;
+	int			i;
+	int			count = (dim / 32) * 32;
+	__m512i		sim = _mm512_setzero_si512();
+	__m512i		na = _mm512_setzero_si512();
+	__m512i		nb = _mm512_setzero_si512();
+
+	for (i = 0; i < count; i += 32)
+	{
+		__m512i		axi = _mm512_cvtepi8_epi16(_mm256_loadu_si256((__m256i *) (ax + i)));
+		__m512i		bxi = _mm512_cvtepi8_epi16(_mm256_loadu_si256((__m256i *) (bx + i)));
+
+		sim = _mm512_dpwssd_epi32(sim, axi, bxi);
+		na = _mm512_dpwssd_epi32(na, axi, axi);
+		nb = _mm512_dpwssd_epi32(nb, bxi, bxi);
+	}
+
+	similarity = _mm512_reduce_add_epi32(sim);
+	norma = _mm512_reduce_add_epi32(na);
+	normb = _mm512_reduce_add_epi32(nb);
+
+	for (; i < dim; i++)
+	{
+		similarity += ax[i] * bx[i];
+		norma += ax[i] * ax[i];
+		normb += bx[i] * bx[i];
+	}
+
+	/* Use sqrt(a * b) over sqrt(a) * sqrt(b) */
+	return (double) similarity / sqrt((double) norma * (double) normb);
+}
+#endif
+
+static int32
+Int8vecL1DistanceDefault(int dim, int8 * ax, int8 * bx)
+{
+	int32		distance = 0;
+
+	/* Auto-vectorized */
+	for (int i = 0; i < dim; i++)
+		distance += abs(ax[i] - bx[i]);
+
+	return distance;
+}
+
+#ifdef INT8VEC_DISPATCH
+TARGET_AVX2 static int32
+Int8vecL1DistanceAvx2(int dim, int8 * ax, int8 * bx)
+{
+	int32		distance;
+	int			i;
+	int			count = (dim / 16) * 16;
+	__m256i		dist = _mm256_setzero_si256();
+	__m256i		ones = _mm256_set1_epi16(1);
+
+	for (i = 0; i < count; i += 16)
+	{
+		__m256i		diff = _mm256_sub_epi16(Int8x16ToInt16(ax + i), Int8x16ToInt16(bx + i));
+
+		dist = _mm256_add_epi32(dist, _mm256_madd_epi16(_mm256_abs_epi16(diff), ones));
+	}
+
+	distance = SumInt32x8(dist);
+
+	for (; i < dim; i++)
+		distance += abs(ax[i] - bx[i]);
+
+	return distance;
+}
+#endif
+
+#ifdef INT8VEC_DISPATCH
+#define CPU_FEATURE_OSXSAVE (1 << 27)
+#define CPU_FEATURE_AVX     (1 << 28)
+
+#define CPU_FEATURE_AVX2     (1 << 5)
+#define CPU_FEATURE_AVX512F  (1 << 16)
+#define CPU_FEATURE_AVX512BW (1 << 30)
+
+#define CPU_FEATURE_AVX512_VNNI (1 << 11)
+
+#ifdef _MSC_VER
+#define TARGET_XSAVE
+#else
+#define TARGET_XSAVE __attribute__((target("xsave")))
+#endif
+
+static void
+GetCpuid(unsigned int leaf, unsigned int subleaf, unsigned int *exx)
+{
+#if defined(USE__GET_CPUID)
+	__get_cpuid_count(leaf, subleaf, &exx[0], &exx[1], &exx[2], &exx[3]);
+#else
+	__cpuidex((int *) exx, leaf, subleaf);
+#endif
+}
+
+TARGET_XSAVE static bool
+SupportsAvx2(void)
+{
+	unsigned int exx[4] = {0, 0, 0, 0};
+	unsigned int features = CPU_FEATURE_OSXSAVE | CPU_FEATURE_AVX;
+
+	GetCpuid(1, 0, exx);
+
+	/* Check OS supports XSAVE */
+	if ((exx[2] & CPU_FEATURE_OSXSAVE) != CPU_FEATURE_OSXSAVE)
+		return false;
+
+	/* Check XMM and YMM registers are enabled */
+	if ((_xgetbv(0) & 6) != 6)
+		return false;
+
+	if ((exx[2] & features) != features)
+		return false;
+
+	GetCpuid(7, 0, exx);
+	return (exx[1] & CPU_FEATURE_AVX2) == CPU_FEATURE_AVX2;
+}
+
+#ifdef INT8VEC_AVX512_VNNI
+TARGET_XSAVE static bool
+SupportsAvx512Vnni(void)
+{
+	unsigned int exx[4] = {0, 0, 0, 0};
+	unsigned int features = CPU_FEATURE_AVX512F | CPU_FEATURE_AVX512BW;
+
+	/* Also checks OS supports XSAVE */
+	if (!SupportsAvx2())
+		return false;
+
+	/* Check opmask, ZMM_Hi256, and Hi16_ZMM registers are enabled */
+	if ((_xgetbv(0) & 0xE6) != 0xE6)
+		return false;
+
+	GetCpuid(7, 0, exx);
+	if ((exx[1] & features) != features)
+		return false;
+
+	return (exx[2] & CPU_FEATURE_AVX512_VNNI) == CPU_FEATURE_AVX512_VNNI;
+}
+#endif
+#endif
+
+void
+Int8vecInit(void)
+{
+	Int8vecL2SquaredDistance = Int8vecL2SquaredDistanceDefault;
+	Int8vecInnerProduct = Int8vecInnerProductDefault;
+	Int8vecCosineSimilarity = Int8vecCosineSimilarityDefault;
+	Int8vecL1Distance = Int8vecL1DistanceDefault;
+
+#ifdef INT8VEC_DISPATCH
+	if (SupportsAvx2())
+	{
+		Int8vecL2SquaredDistance = Int8vecL2SquaredDistanceAvx2;
+		Int8vecInnerProduct = Int8vecInnerProductAvx2;
+		Int8vecCosineSimilarity = Int8vecCosineSimilarityAvx2;
+		Int8vecL1Distance = Int8vecL1DistanceAvx2;
+	}
+
+#ifdef INT8VEC_AVX512_VNNI
+	/* L1 has no multiply to fuse */
+	if (SupportsAvx512Vnni())
+	{
+		Int8vecL2SquaredDistance = Int8vecL2SquaredDistanceAvx512Vnni;
+		Int8vecInnerProduct = Int8vecInnerProductAvx512Vnni;
+		Int8vecCosineSimilarity = Int8vecCosineSimilarityAvx512Vnni;
+	}
+#endif
+#endif
+}
@@ -0,0 +1,40 @@
+#ifndef INT8UTILS_H
+#define INT8UTILS_H
+
+#include <math.h>
+
+#include "common/shortest_dec.h"
+#include "int8vec.h"
+
+/* Sums fit in int32 since each term is at most 255 * 255 */
+extern int32 (*Int8vecL2SquaredDistance) (int dim, int8 * ax, int8 * bx);
+extern int32 (*Int8vecInnerProduct) (int dim, int8 * ax, int8 * bx);
+extern double (*Int8vecCosineSimilarity) (int dim, int8 * ax, int8 * bx);
+extern int32 (*Int8vecL1Distance) (int dim, int8 * ax, int8 * bx);
+
+void		Int8vecInit(void);
+
+/*
+ * Convert a float4 to an int8, rounding to the nearest integer
+ */
+static inline int8
+Float4ToInt8(float num)
+{
+	float		r = rintf(num);
+
+	/* Also catches NaN */
+	if (unlikely(!(r >= PG_INT8_MIN && r <= PG_INT8_MAX)))
+	{
+		char	   *buf = palloc(FLOAT_SHORTEST_DECIMAL_LEN);
+
+		float_to_shortest_decimal_buf(num, buf);
+
+		ereport(ERROR,
+				(errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
+				 errmsg("\"%s\" is out of range for type int8vec", buf)));
+	}
+
+	return (int8) r;
+}
+
+#endif
@@ -0,0 +1,715 @@
+#include "postgres.h"
+
+#include <math.h>
+
+#include "catalog/pg_type.h"
+#include "fmgr.h"
+#include "int8utils.h"
+#include "int8vec.h"
+#include "lib/stringinfo.h"
+#include "libpq/pqformat.h"
+#include "utils/array.h"
+#include "utils/builtins.h"
+#include "utils/lsyscache.h"
+#include "vector.h"
+
+#if PG_VERSION_NUM >= 140000
+#define AppendInt(ptr, i) ((ptr) += pg_ltoa((i), (ptr)))
+#else
+#define AppendInt(ptr, i) \
+	do { \
+		pg_ltoa(i, ptr); \
+		while (*ptr != '\0') \
+			ptr++; \
+	} while (0)
+#endif
+
+#define AppendChar(ptr, c) (*(ptr)++ = (c))
+
+/*
+ * Ensure same dimensions
+ */
+static inline void
+CheckDims(Int8Vector * a, Int8Vector * b)
+{
+	if (a->dim != b->dim)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_EXCEPTION),
+				 errmsg("different int8vec dimensions %d and %d", a->dim, b->dim)));
+}
+
+/*
+ * Ensure expected dimensions
+ */
+static inline void
+CheckExpectedDim(int32 typmod, int dim)
+{
+	if (typmod != -1 && typmod != dim)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_EXCEPTION),
+				 errmsg("expected %d dimensions, not %d", typmod, dim)));
+}
+
+/*
+ * Ensure valid dimensions
+ */
+static inline void
+CheckDim(int dim)
+{
+	if (dim < 1)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_EXCEPTION),
+				 errmsg("int8vec must have at least 1 dimension")));
+
+	if (dim > INT8VEC_MAX_DIM)
+		ereport(ERROR,
+				(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+				 errmsg("int8vec cannot have more than %d dimensions", INT8VEC_MAX_DIM)));
+}
+
+/*
+ * Allocate and initialize a new int8 vector
+ */
+Int8Vector *
+InitInt8Vector(int dim)
+{
+	Int8Vector *result;
+	int			size;
+
+	size = INT8VEC_SIZE(dim);
+	result = (Int8Vector *) palloc0(size);
+	SET_VARSIZE(result, size);
+	result->dim = dim;
+
+	return result;
+}
+
+/*
+ * Check for whitespace, since array_isspace() is static
+ */
+static inline bool
+int8vec_isspace(char ch)
+{
+	if (ch == ' ' ||
+		ch == '\t' ||
+		ch == '\n' ||
+		ch == '\r' ||
+		ch == '\v' ||
+		ch == '\f')
+		return true;
+	return false;
+}
+
+/*
+ * Convert textual representation to internal representation
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(int8vec_in);
+Datum
+int8vec_in(PG_FUNCTION_ARGS)
+{
+	char	   *lit = PG_GETARG_CSTRING(0);
+	int32		typmod = PG_GETARG_INT32(2);
+	int8		x[INT8VEC_MAX_DIM];
+	int			dim = 0;
+	char	   *pt = lit;
+	Int8Vector *result;
+
+	while (int8vec_isspace(*pt))
+		pt++;
+
+	if (*pt != '[')
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
+				 errmsg("invalid input syntax for type int8vec: \"%s\"", lit),
+				 errdetail("Vector contents must start with \"[\".")));
+
+	pt++;
+
+	while (int8vec_isspace(*pt))
+		pt++;
+
+	if (*pt == ']')
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_EXCEPTION),
+				 errmsg("int8vec must have at least 1 dimension")));
+
+	for (;;)
+	{
+		long		val;
+		char	   *stringEnd;
+
+		if (dim == INT8VEC_MAX_DIM)
+			ereport(ERROR,
+					(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+					 errmsg("int8vec cannot have more than %d dimensions", INT8VEC_MAX_DIM)));
+
+		while (int8vec_isspace(*pt))
+			pt++;
+
+		/* Check for empty string like int2in */
+		if (*pt == '\0')
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
+					 errmsg("invalid input syntax for type int8vec: \"%s\"", lit)));
+
+		errno = 0;
+
+		/* Use similar logic as int2vectorin */
+		val = strtol(pt, &stringEnd, 10);
+
+		if (stringEnd == pt)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
+					 errmsg("invalid input syntax for type int8vec: \"%s\"", lit)));
+
+		if (errno == ERANGE || val < PG_INT8_MIN || val > PG_INT8_MAX)
+			ereport(ERROR,
+					(errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
+					 errmsg("\"%s\" is out of range for type int8vec", pnstrdup(pt, stringEnd - pt))));
+
+		x[dim++] = (int8) val;
+
+		pt = stringEnd;
+
+		while (int8vec_isspace(*pt))
+			pt++;
+
+		if (*pt == ',')
+			pt++;
+		else if (*pt == ']')
+		{
+			pt++;
+			break;
+		}
+		else
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
+					 errmsg("invalid input syntax for type int8vec: \"%s\"", lit)));
+	}
+
+	/* Only whitespace is allowed after the closing brace */
+	while (int8vec_isspace(*pt))
+		pt++;
+
+	if (*pt != '\0')
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_TEXT_REPRESENTATION),
+				 errmsg("invalid input syntax for type int8vec: \"%s\"", lit),
+				 errdetail("Junk after closing right brace.")));
+
+	CheckDim(dim);
+	CheckExpectedDim(typmod, dim);
+
+	result = InitInt8Vector(dim);
+	for (int i = 0; i < dim; i++)
+		result->x[i] = x[i];
+
+	PG_RETURN_POINTER(result);
+}
+
+/*
+ * Convert internal representation to textual representation
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(int8vec_out);
+Datum
+int8vec_out(PG_FUNCTION_ARGS)
+{
+	Int8Vector *vector = PG_GETARG_INT8VEC_P(0);
+	int			dim = vector->dim;
+	char	   *buf;
+	char	   *ptr;
+
+	/*
+	 * Need:
+	 *
+	 * dim * 4 bytes for elements (like -128)
+	 *
+	 * dim - 1 bytes for separator
+	 *
+	 * 3 bytes for [, ], and \0
+	 */
+	buf = (char *) palloc(5 * dim + 2);
+	ptr = buf;
+
+	AppendChar(ptr, '[');
+
+	for (int i = 0; i < dim; i++)
+	{
+		if (i > 0)
+			AppendChar(ptr, ',');
+
+		AppendInt(ptr, vector->x[i]);
+	}
+
+	AppendChar(ptr, ']');
+	*ptr = '\0';
+
+	PG_FREE_IF_COPY(vector, 0);
+	PG_RETURN_CSTRING(buf);
+}
+
+/*
+ * Convert type modifier
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(int8vec_typmod_in);
+Datum
+int8vec_typmod_in(PG_FUNCTION_ARGS)
+{
+	ArrayType  *ta = PG_GETARG_ARRAYTYPE_P(0);
+	int32	   *tl;
+	int			n;
+
+	tl = ArrayGetIntegerTypmods(ta, &n);
+
+	if (n != 1)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("invalid type modifier")));
+
+	if (*tl < 1)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("dimensions for type int8vec must be at least 1")));
+
+	if (*tl > INT8VEC_MAX_DIM)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("dimensions for type int8vec cannot exceed %d", INT8VEC_MAX_DIM)));
+
+	PG_RETURN_INT32(*tl);
+}
+
+/*
+ * Convert external binary representation to internal representation
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(int8vec_recv);
+Datum
+int8vec_recv(PG_FUNCTION_ARGS)
+{
+	StringInfo	buf = (StringInfo) PG_GETARG_POINTER(0);
+	int32		typmod = PG_GETARG_INT32(2);
+	Int8Vector *result;
+	int16		dim;
+	int16		unused;
+
+	dim = pq_getmsgint(buf, sizeof(int16));
+	unused = pq_getmsgint(buf, sizeof(int16));
+
+	CheckDim(dim);
+	CheckExpectedDim(typmod, dim);
+
+	if (unused != 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_EXCEPTION),
+				 errmsg("expected unused to be 0, not %d", unused)));
+
+	result = InitInt8Vector(dim);
+	for (int i = 0; i < dim; i++)
+		result->x[i] = (int8) pq_getmsgbyte(buf);
+
+	PG_RETURN_POINTER(result);
+}
+
+/*
+ * Convert internal representation to the external binary representation
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(int8vec_send);
+Datum
+int8vec_send(PG_FUNCTION_ARGS)
+{
+	Int8Vector *vec = PG_GETARG_INT8VEC_P(0);
+	StringInfoData buf;
+
+	pq_begintypsend(&buf);
+	pq_sendint(&buf, vec->dim, sizeof(int16));
+	pq_sendint(&buf, vec->unused, sizeof(int16));
+	pq_sendbytes(&buf, (char *) vec->x, vec->dim);
+
+	PG_RETURN_BYTEA_P(pq_endtypsend(&buf));
+}
+
+/*
+ * Convert int8 vector to int8 vector
+ * This is needed to check the type modifier
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(int8vec);
+Datum
+int8vec(PG_FUNCTION_ARGS)
+{
+	Int8Vector *vec = PG_GETARG_INT8VEC_P(0);
+	int32		typmod = PG_GETARG_INT32(1);
+
+	CheckExpectedDim(typmod, vec->dim);
+
+	PG_RETURN_POINTER(vec);
+}
+
+/*
+ * Convert integer array to int8 vector
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(array_to_int8vec);
+Datum
+array_to_int8vec(PG_FUNCTION_ARGS)
+{
+	ArrayType  *array = PG_GETARG_ARRAYTYPE_P(0);
+	int32		typmod = PG_GETARG_INT32(1);
+	Int8Vector *result;
+	int16		typlen;
+	bool		typbyval;
+	char		typalign;
+	Datum	   *elemsp;
+	int			nelemsp;
+
+	if (ARR_NDIM(array) > 1)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_EXCEPTION),
+				 errmsg("array must be 1-D")));
+
+	if (ARR_HASNULL(array) && array_contains_nulls(array))
+		ereport(ERROR,
+				(errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+				 errmsg("array must not contain nulls")));
+
+	if (ARR_ELEMTYPE(array) != INT4OID)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_EXCEPTION),
+				 errmsg("unsupported array type")));
+
+	get_typlenbyvalalign(ARR_ELEMTYPE(array), &typlen, &typbyval, &typalign);
+	deconstruct_array(array, ARR_ELEMTYPE(array), typlen, typbyval, typalign, &elemsp, NULL, &nelemsp);
+
+	CheckDim(nelemsp);
+	CheckExpectedDim(typmod, nelemsp);
+
+	result = InitInt8Vector(nelemsp);
+
+	for (int i = 0; i < nelemsp; i++)
+	{
+		int32		val = DatumGetInt32(elemsp[i]);
+
+		if (val < PG_INT8_MIN || val > PG_INT8_MAX)
+			ereport(ERROR,
+					(errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
+					 errmsg("\"%d\" is out of range for type int8vec", val)));
+
+		result->x[i] = (int8) val;
+	}
+
+	pfree(elemsp);
+
+	PG_RETURN_POINTER(result);
+}
+
+/*
+ * Convert int8 vector to integer[]
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(int8vec_to_int4);
+Datum
+int8vec_to_int4(PG_FUNCTION_ARGS)
+{
+	Int8Vector *vec = PG_GETARG_INT8VEC_P(0);
+	Datum	   *datums;
+	ArrayType  *result;
+
+	datums = (Datum *) palloc(sizeof(Datum) * vec->dim);
+
+	for (int i = 0; i < vec->dim; i++)
+		datums[i] = Int32GetDatum(vec->x[i]);
+
+	/* Use TYPALIGN_INT for int4 */
+	result = construct_array(datums, vec->dim, INT4OID, sizeof(int32), true, TYPALIGN_INT);
+
+	pfree(datums);
+
+	PG_RETURN_POINTER(result);
+}
+
+/*
+ * Convert vector to int8 vector
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(vector_to_int8vec);
+Datum
+vector_to_int8vec(PG_FUNCTION_ARGS)
+{
+	Vector	   *vec = PG_GETARG_VECTOR_P(0);
+	int32		typmod = PG_GETARG_INT32(1);
+	Int8Vector *result;
+
+	CheckDim(vec->dim);
+	CheckExpectedDim(typmod, vec->dim);
+
+	result = InitInt8Vector(vec->dim);
+
+	for (int i = 0; i < vec->dim; i++)
+		result->x[i] = Float4ToInt8(vec->x[i]);
+
+	PG_RETURN_POINTER(result);
+}
+
+/*
+ * Convert int8 vector to vector
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(int8vec_to_vector);
+Datum
+int8vec_to_vector(PG_FUNCTION_ARGS)
+{
+	Int8Vector *vec = PG_GETARG_INT8VEC_P(0);
+	int32		typmod = PG_GETARG_INT32(1);
+	Vector	   *result;
+
+	CheckExpectedDim(typmod, vec->dim);
+
+	result = InitVector(vec->dim);
+
+	for (int i = 0; i < vec->dim; i++)
+		result->x[i] = vec->x[i];
+
+	PG_RETURN_POINTER(result);
+}
+
+/*
+ * Get the L2 distance between int8 vectors
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(int8vec_l2_distance);
+Datum
+int8vec_l2_distance(PG_FUNCTION_ARGS)
+{
+	Int8Vector *a = PG_GETARG_INT8VEC_P(0);
+	Int8Vector *b = PG_GETARG_INT8VEC_P(1);
+
+	CheckDims(a, b);
+
+	PG_RETURN_FLOAT8(sqrt((double) Int8vecL2SquaredDistance(a->dim, a->x, b->x)));
+}
+
+/*
+ * Get the L2 squared distance between int8 vectors
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(int8vec_l2_squared_distance);
+Datum
+int8vec_l2_squared_distance(PG_FUNCTION_ARGS)
+{
+	Int8Vector *a = PG_GETARG_INT8VEC_P(0);
+	Int8Vector *b = PG_GETARG_INT8VEC_P(1);
+
+	CheckDims(a, b);
+
+	PG_RETURN_FLOAT8((double) Int8vecL2SquaredDistance(a->dim, a->x, b->x));
+}
+
+/*
+ * Get the inner product of two int8 vectors
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(int8vec_inner_product);
+Datum
+int8vec_inner_product(PG_FUNCTION_ARGS)
+{
+	Int8Vector *a = PG_GETARG_INT8VEC_P(0);
+	Int8Vector *b = PG_GETARG_INT8VEC_P(1);
+
+	CheckDims(a, b);
+
+	PG_RETURN_FLOAT8((double) Int8vecInnerProduct(a->dim, a->x, b->x));
+}
+
+/*
+ * Get the negative inner product of two int8 vectors
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(int8vec_negative_inner_product);
+Datum
+int8vec_negative_inner_product(PG_FUNCTION_ARGS)
+{
+	Int8Vector *a = PG_GETARG_INT8VEC_P(0);
+	Int8Vector *b = PG_GETARG_INT8VEC_P(1);
+
+	CheckDims(a, b);
+
+	PG_RETURN_FLOAT8((double) -Int8vecInnerProduct(a->dim, a->x, b->x));
+}
+
+/*
+ * Get the cosine distance between two int8 vectors
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(int8vec_cosine_distance);
+Datum
+int8vec_cosine_distance(PG_FUNCTION_ARGS)
+{
+	Int8Vector *a = PG_GETARG_INT8VEC_P(0);
+	Int8Vector *b = PG_GETARG_INT8VEC_P(1);
+	double		similarity;
+
+	CheckDims(a, b);
+
+	similarity = Int8vecCosineSimilarity(a->dim, a->x, b->x);
+
+#ifdef _MSC_VER
+	/* /fp:fast may not propagate NaN */
+	if (isnan(similarity))
+		PG_RETURN_FLOAT8(NAN);
+#endif
+
+	/* Keep in range */
+	if (similarity > 1)
+		similarity = 1;
+	else if (similarity < -1)
+		similarity = -1;
+
+	PG_RETURN_FLOAT8(1 - similarity);
+}
+
+/*
+ * Get the L1 distance between two int8 vectors
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(int8vec_l1_distance);
+Datum
+int8vec_l1_distance(PG_FUNCTION_ARGS)
+{
+	Int8Vector *a = PG_GETARG_INT8VEC_P(0);
+	Int8Vector *b = PG_GETARG_INT8VEC_P(1);
+
+	CheckDims(a, b);
+
+	PG_RETURN_FLOAT8((double) Int8vecL1Distance(a->dim, a->x, b->x));
+}
+
+/*
+ * Get the dimensions of an int8 vector
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(int8vec_vector_dims);
+Datum
+int8vec_vector_dims(PG_FUNCTION_ARGS)
+{
+	Int8Vector *a = PG_GETARG_INT8VEC_P(0);
+
+	PG_RETURN_INT32(a->dim);
+}
+
+/*
+ * Get the L2 norm of an int8 vector
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(int8vec_l2_norm);
+Datum
+int8vec_l2_norm(PG_FUNCTION_ARGS)
+{
+	Int8Vector *a = PG_GETARG_INT8VEC_P(0);
+
+	PG_RETURN_FLOAT8(sqrt((double) Int8vecInnerProduct(a->dim, a->x, a->x)));
+}
+
+/*
+ * Internal helper to compare int8 vectors
+ */
+static int
+int8vec_cmp_internal(Int8Vector * a, Int8Vector * b)
+{
+	int			dim = Min(a->dim, b->dim);
+
+	/* Check values before dimensions to be consistent with Postgres arrays */
+	for (int i = 0; i < dim; i++)
+	{
+		if (a->x[i] < b->x[i])
+			return -1;
+
+		if (a->x[i] > b->x[i])
+			return 1;
+	}
+
+	if (a->dim < b->dim)
+		return -1;
+
+	if (a->dim > b->dim)
+		return 1;
+
+	return 0;
+}
+
+/*
+ * Less than
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(int8vec_lt);
+Datum
+int8vec_lt(PG_FUNCTION_ARGS)
+{
+	Int8Vector *a = PG_GETARG_INT8VEC_P(0);
+	Int8Vector *b = PG_GETARG_INT8VEC_P(1);
+
+	PG_RETURN_BOOL(int8vec_cmp_internal(a, b) < 0);
+}
+
+/*
+ * Less than or equal
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(int8vec_le);
+Datum
+int8vec_le(PG_FUNCTION_ARGS)
+{
+	Int8Vector *a = PG_GETARG_INT8VEC_P(0);
+	Int8Vector *b = PG_GETARG_INT8VEC_P(1);
+
+	PG_RETURN_BOOL(int8vec_cmp_internal(a, b) <= 0);
+}
+
+/*
+ * Equal
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(int8vec_eq);
+Datum
+int8vec_eq(PG_FUNCTION_ARGS)
+{
+	Int8Vector *a = PG_GETARG_INT8VEC_P(0);
+	Int8Vector *b = PG_GETARG_INT8VEC_P(1);
+
+	PG_RETURN_BOOL(int8vec_cmp_internal(a, b) == 0);
+}
+
+/*
+ * Not equal
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(int8vec_ne);
+Datum
+int8vec_ne(PG_FUNCTION_ARGS)
+{
+	Int8Vector *a = PG_GETARG_INT8VEC_P(0);
+	Int8Vector *b = PG_GETARG_INT8VEC_P(1);
+
+	PG_RETURN_BOOL(int8vec_cmp_internal(a, b) != 0);
+}
+
+/*
+ * Greater than or equal
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(int8vec_ge);
+Datum
+int8vec_ge(PG_FUNCTION_ARGS)
+{
+	Int8Vector *a = PG_GETARG_INT8VEC_P(0);
+	Int8Vector *b = PG_GETARG_INT8VEC_P(1);
+
+	PG_RETURN_BOOL(int8vec_cmp_internal(a, b) >= 0);
+}
+
+/*
+ * Greater than
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(int8vec_gt);
+Datum
+int8vec_gt(PG_FUNCTION_ARGS)
+{
+	Int8Vector *a = PG_GETARG_INT8VEC_P(0);
+	Int8Vector *b = PG_GETARG_INT8VEC_P(1);
+
+	PG_RETURN_BOOL(int8vec_cmp_internal(a, b) > 0);
+}
+
+/*
+ * Compare int8 vectors
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(int8vec_cmp);
+Datum
+int8vec_cmp(PG_FUNCTION_ARGS)
+{
+	Int8Vector *a = PG_GETARG_INT8VEC_P(0);
+	Int8Vector *b = PG_GETARG_INT8VEC_P(1);
+
+	PG_RETURN_INT32(int8vec_cmp_internal(a, b));
+}
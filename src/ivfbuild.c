@@ -7,17 +7,26 @@
 #include "access/parallel.h"
 #include "access/xact.h"
 #include "bitvec.h"
+#include "catalog/dependency.h"
 #include "catalog/index.h"
+#include "catalog/namespace.h"
+#include "catalog/pg_class_d.h"
 #include "catalog/pg_operator_d.h"
 #include "catalog/pg_type_d.h"
 #include "commands/progress.h"
+#include "executor/tuptable.h"
 #include "halfvec.h"
 #include "ivfflat.h"
 #include "miscadmin.h"
+#include "numautils.h"
 #include "optimizer/optimizer.h"
 #include "storage/bufmgr.h"
 #include "tcop/tcopprot.h"
+#include "utils/acl.h"
+#include "utils/builtins.h"
+#include "utils/lsyscache.h"
 #include "utils/memutils.h"
+#include "utils/snapmgr.h"
 #include "vector.h"
 
 #if PG_VERSION_NUM >= 160000
@@ -401,16 +410,219 @@ FreeBuildState(IvfflatBuildState * buildstate)
 	MemoryContextDelete(buildstate->tmpCtx);
 }
 
+/*
+ * Add a center
+ */
+static void
+AddCenter(IvfflatBuildState * buildstate, Datum value)
+{
+	VectorArray centers = buildstate->centers;
+
+	if (centers->length == buildstate->lists)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("centers_from must have %d centers", buildstate->lists)));
+
+	value = PointerGetDatum(PG_DETOAST_DATUM(value));
+
+	if (VARSIZE_ANY(DatumGetPointer(value)) != buildstate->typeInfo->itemSize(buildstate->dimensions))
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_EXCEPTION),
+				 errmsg("expected %d dimensions for center", buildstate->dimensions)));
+
+	/* Keep centers on the unit sphere like spherical k-means */
+	if (buildstate->kmeansnormprocinfo != NULL)
+	{
+		if (!IvfflatCheckNorm(buildstate->kmeansnormprocinfo, buildstate->collation, value))
+			ereport(ERROR,
+					(errcode(ERRCODE_DATA_EXCEPTION),
+					 errmsg("center must not have zero norm")));
+
+		value = IvfflatNormValue(buildstate->typeInfo, buildstate->collation, value);
+	}
+
+	VectorArraySet(centers, centers->length, DatumGetPointer(value));
+	centers->length++;
+}
+
+/*
+ * Load centers from the list pages of another index
+ */
+static void
+LoadCentersFromIndex(IvfflatBuildState * buildstate, Relation source)
+{
+	BlockNumber nextblkno = IVFFLAT_HEAD_BLKNO;
+
+	if (source->rd_rel->relam != buildstate->index->rd_rel->relam ||
+		TupleDescAttr(source->rd_att, 0)->atttypid != TupleDescAttr(buildstate->tupdesc, 0)->atttypid)
+		ereport(ERROR,
+				(errcode(ERRCODE_WRONG_OBJECT_TYPE),
+				 errmsg("centers_from index must be an ivfflat index on the same type")));
+
+	while (BlockNumberIsValid(nextblkno))
+	{
+		Buffer		buf;
+		Page		page;
+		OffsetNumber maxoffno;
+
+		buf = ReadBuffer(source, nextblkno);
+		LockBuffer(buf, BUFFER_LOCK_SHARE);
+		page = BufferGetPage(buf);
+		maxoffno = PageGetMaxOffsetNumber(page);
+
+		for (OffsetNumber offno = FirstOffsetNumber; offno <= maxoffno; offno = OffsetNumberNext(offno))
+		{
+			IvfflatList list = (IvfflatList) PageGetItem(page, PageGetItemId(page, offno));
+
+			AddCenter(buildstate, PointerGetDatum(&list->center));
+		}
+
+		nextblkno = IvfflatPageGetOpaque(page)->nextblkno;
+
+		UnlockReleaseBuffer(buf);
+	}
+}
+
+/*
+ * Load centers from the rows of a table
+ */
+static void
+LoadCentersFromTable(IvfflatBuildState * buildstate, Relation source)
+{
+	TupleDesc	tupdesc = RelationGetDescr(source);
+	Oid			typid = TupleDescAttr(buildstate->tupdesc, 0)->atttypid;
+	AttrNumber	attnum = InvalidAttrNumber;
+	TableScanDesc scan;
+	TupleTableSlot *slot;
+
+	for (int i = 0; i < tupdesc->natts; i++)
+	{
+		Form_pg_attribute attr = TupleDescAttr(tupdesc, i);
+
+		if (attr->attisdropped)
+			continue;
+
+		if (AttributeNumberIsValid(attnum) || attr->atttypid != typid)
+		{
+			attnum = InvalidAttrNumber;
+			break;
+		}
+
+		attnum = attr->attnum;
+	}
+
+	if (!AttributeNumberIsValid(attnum))
+		ereport(ERROR,
+				(errcode(ERRCODE_DATATYPE_MISMATCH),
+				 errmsg("centers_from table must have a single column of type %s", format_type_be(typid))));
+
+	slot = table_slot_create(source, NULL);
+	scan = table_beginscan(source, GetActiveSnapshot(), 0, NULL);
+
+	while (table_scan_getnextslot(scan, ForwardScanDirection, slot))
+	{
+		bool		isnull;
+		Datum		value = slot_getattr(slot, attnum, &isnull);
+
+		if (isnull)
+			ereport(ERROR,
+					(errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+					 errmsg("center cannot be null")));
+
+		AddCenter(buildstate, value);
+	}
+
+	table_endscan(scan);
+	ExecDropSingleTupleTableSlot(slot);
+}
+
+/*
+ * Record a dependency on the source of centers
+ */
+static void
+RecordCentersDependency(IvfflatBuildState * buildstate, Oid relid)
+{
+	ObjectAddress myself;
+	ObjectAddress referenced;
+	Oid			heapid = RelationGetRelid(buildstate->heap);
+
+	/* The index already depends on its table */
+	if (relid == heapid)
+		return;
+
+	/* REINDEX CONCURRENTLY swaps dependencies between indexes on the table */
+	if (get_rel_relkind(relid) == RELKIND_INDEX && IndexGetRelation(relid, false) == heapid)
+		return;
+
+	ObjectAddressSet(myself, RelationRelationId, RelationGetRelid(buildstate->index));
+	ObjectAddressSet(referenced, RelationRelationId, relid);
+	recordDependencyOn(&myself, &referenced, DEPENDENCY_NORMAL);
+}
+
+/*
+ * Load centers from a table or index
+ */
+static bool
+LoadCenters(IvfflatBuildState * buildstate, const char *centersFrom)
+{
+	List	   *names = IvfflatParseCentersFrom(centersFrom);
+	Oid			relid = RangeVarGetRelid(makeRangeVarFromNameList(names), AccessShareLock, false);
+	char		relkind = get_rel_relkind(relid);
+	Relation	source;
+
+	/* Storage has already been replaced when rebuilding in place */
+	if (relid == RelationGetRelid(buildstate->index))
+		return false;
+
+	if (relkind == RELKIND_INDEX)
+	{
+		source = index_open(relid, AccessShareLock);
+		LoadCentersFromIndex(buildstate, source);
+		index_close(source, AccessShareLock);
+	}
+	else if (relkind == RELKIND_RELATION || relkind == RELKIND_MATVIEW)
+	{
+		if (pg_class_aclcheck(relid, GetUserId(), ACL_SELECT) != ACLCHECK_OK)
+			aclcheck_error(ACLCHECK_NO_PRIV, get_relkind_objtype(relkind), get_rel_name(relid));
+
+		source = table_open(relid, AccessShareLock);
+		LoadCentersFromTable(buildstate, source);
+		table_close(source, AccessShareLock);
+	}
+	else
+		ereport(ERROR,
+				(errcode(ERRCODE_WRONG_OBJECT_TYPE),
+				 errmsg("centers_from must be a table or ivfflat index")));
+
+	if (buildstate->centers->length != buildstate->lists)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("centers_from must have %d centers", buildstate->lists)));
+
+	RecordCentersDependency(buildstate, relid);
+
+	return true;
+}
+
 /*
  * Compute centers
  */
 static void
 ComputeCenters(IvfflatBuildState * buildstate)
 {
+	char	   *centersFrom = IvfflatGetCentersFrom(buildstate->index);
 	int			numSamples;
 
 	pgstat_progress_update_param(PROGRESS_CREATEIDX_SUBPHASE, PROGRESS_IVFFLAT_PHASE_KMEANS);
 
+	/* Remove the dependency from a previous build */
+	if (buildstate->heap != NULL)
+		deleteDependencyRecordsForClass(RelationRelationId, RelationGetRelid(buildstate->index), RelationRelationId, DEPENDENCY_NORMAL);
+
+	/* Skip sampling and k-means when centers are provided */
+	if (centersFrom != NULL && buildstate->heap != NULL && LoadCenters(buildstate, centersFrom))
+		return;
+
 	/* Target 50 samples per list, with at least 10000 samples */
 	/* The number of samples has a large effect on index build time */
 	numSamples = buildstate->lists * 50;
@@ -713,6 +925,9 @@ IvfflatParallelBuildMain(dsm_segment *seg, shm_toc *toc)
 		indexLockmode = RowExclusiveLock;
 	}
 
+	/* Run on one node so the copy of centers and sort memory are local */
+	NumaSetWorkerAffinity(ParallelWorkerNumber);
+
 	/* Open relations within worker */
 	heapRel = table_open(ivfshared->heaprelid, heapLockmode);
 	indexRel = index_open(ivfshared->indexrelid, indexLockmode);
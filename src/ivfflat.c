@@ -27,6 +27,16 @@ static const struct config_enum_entry ivfflat_iterative_scan_options[] = {
 	{NULL, 0, false}
 };
 
+/*
+ * Validate the source of centers
+ */
+static void
+IvfflatValidateCentersFrom(const char *value)
+{
+	if (value != NULL)
+		(void) IvfflatParseCentersFrom(value);
+}
+
 /*
  * Initialize index options and variables
  */
@@ -36,6 +46,10 @@ IvfflatInit(void)
 	ivfflat_relopt_kind = add_reloption_kind();
 	add_int_reloption(ivfflat_relopt_kind, "lists", "Number of inverted lists",
 					  IVFFLAT_DEFAULT_LISTS, IVFFLAT_MIN_LISTS, IVFFLAT_MAX_LISTS, AccessExclusiveLock);
+	add_int_reloption(ivfflat_relopt_kind, "probes", "Min number of probes",
+					  0, 0, IVFFLAT_MAX_LISTS, ShareUpdateExclusiveLock);
+	add_string_reloption(ivfflat_relopt_kind, "centers_from", "Table or index to load centers from",
+						 NULL, IvfflatValidateCentersFrom, AccessExclusiveLock);
 
 	DefineCustomIntVariable("ivfflat.probes", "Sets the number of probes",
 							"Valid range is 1..lists.", &ivfflat_probes,
@@ -85,6 +99,7 @@ ivfflatcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
 {
 	GenericCosts costs;
 	int			lists;
+	int			probes;
 	double		ratio;
 	double		sequentialRatio = 0.5;
 	double		startupPages;
@@ -112,10 +127,11 @@ ivfflatcostestimate(PlannerInfo *root, IndexPath *path, double loop_count,
 
 	index = index_open(path->indexinfo->indexoid, NoLock);
 	IvfflatGetMetaPageInfo(index, &lists, NULL);
+	probes = IvfflatGetProbes(index);
 	index_close(index, NoLock);
 
 	/* Get the ratio of lists that we need to visit */
-	ratio = ((double) ivfflat_probes) / lists;
+	ratio = ((double) probes) / lists;
 	if (ratio > 1.0)
 		ratio = 1.0;
 
@@ -153,6 +169,8 @@ ivfflatoptions(Datum reloptions, bool validate)
 {
 	static const relopt_parse_elt tab[] = {
 		{"lists", RELOPT_TYPE_INT, offsetof(IvfflatOptions, lists)},
+		{"probes", RELOPT_TYPE_INT, offsetof(IvfflatOptions, probes)},
+		{"centers_from", RELOPT_TYPE_STRING, offsetof(IvfflatOptions, centersFromOffset)},
 	};
 
 	return (bytea *) build_reloptions(reloptions, validate,
@@ -117,6 +117,8 @@ typedef struct IvfflatOptions
 {
 	int32		vl_len_;		/* varlena header (do not touch directly!) */
 	int			lists;			/* number of lists */
+	int			probes;			/* min number of probes */
+	int			centersFromOffset;	/* source of centers */
 }			IvfflatOptions;
 
 typedef struct IvfflatSpool
@@ -172,6 +174,17 @@ typedef struct IvfflatTypeInfo
 	void		(*sumCenter) (Pointer v, float *x);
 }			IvfflatTypeInfo;
 
+extern const IvfflatTypeInfo IvfflatVectorTypeInfo;
+extern const IvfflatTypeInfo IvfflatHalfvecTypeInfo;
+
+typedef struct IvfflatKmeansSupport
+{
+	FmgrInfo   *procinfo;
+	FmgrInfo   *normprocinfo;
+	FmgrInfo   *checknormprocinfo;
+	Oid			collation;
+}			IvfflatKmeansSupport;
+
 typedef struct IvfflatBuildState
 {
 	/* Info */
@@ -310,10 +323,14 @@ VectorArraySet(VectorArray arr, int offset, Pointer val)
 VectorArray VectorArrayInit(int maxlen, int dimensions, Size itemsize);
 void		VectorArrayFree(VectorArray arr);
 void		IvfflatKmeans(Relation index, VectorArray samples, VectorArray centers, const IvfflatTypeInfo * typeInfo);
+void		IvfflatKmeansWithSupport(IvfflatKmeansSupport * support, VectorArray samples, VectorArray centers, const IvfflatTypeInfo * typeInfo, int maxIterations);
 FmgrInfo   *IvfflatOptionalProcInfo(Relation index, uint16 procnum);
 Datum		IvfflatNormValue(const IvfflatTypeInfo * typeInfo, Oid collation, Datum value);
 bool		IvfflatCheckNorm(FmgrInfo *procinfo, Oid collation, Datum value);
 int			IvfflatGetLists(Relation index);
+int			IvfflatGetProbes(Relation index);
+char	   *IvfflatGetCentersFrom(Relation index);
+List	   *IvfflatParseCentersFrom(const char *centersFrom);
 void		IvfflatGetMetaPageInfo(Relation index, int *lists, int *dimensions);
 void		IvfflatUpdateList(Relation index, ListInfo listInfo, BlockNumber insertPage, BlockNumber originalInsertPage, BlockNumber startPage, ForkNumber forkNum);
 void		IvfflatCommitBuffer(Buffer buf, GenericXLogState *state);
@@ -8,8 +8,10 @@
 #include "halfvec.h"
 #include "ivfflat.h"
 #include "miscadmin.h"
+#include "utils/array.h"
 #include "utils/builtins.h"
 #include "utils/datum.h"
+#include "utils/lsyscache.h"
 #include "utils/memutils.h"
 #include "vector.h"
 
@@ -23,18 +25,15 @@
  * https://theory.stanford.edu/~sergei/papers/kMeansPP-soda.pdf
  */
 static void
-InitCenters(Relation index, VectorArray samples, VectorArray centers, float *lowerBound)
+InitCenters(IvfflatKmeansSupport * support, VectorArray samples, VectorArray centers, float *lowerBound)
 {
-	FmgrInfo   *procinfo;
-	Oid			collation;
+	FmgrInfo   *procinfo = support->procinfo;
+	Oid			collation = support->collation;
 	int64		j;
 	float	   *weight = palloc(samples->length * sizeof(float));
 	int			numCenters = centers->maxlen;
 	int			numSamples = samples->length;
 
-	procinfo = index_getprocinfo(index, 1, IVFFLAT_KMEANS_DISTANCE_PROC);
-	collation = index->rd_indcollation[0];
-
 	/* Choose an initial center uniformly at random */
 	VectorArraySet(centers, 0, VectorArrayGet(samples, RandomInt() % samples->length));
 	centers->length++;
@@ -124,11 +123,9 @@ NormCenters(const IvfflatTypeInfo * typeInfo, Oid collation, VectorArray centers
  * Quick approach if we have no data
  */
 static void
-RandomCenters(Relation index, VectorArray centers, const IvfflatTypeInfo * typeInfo)
+RandomCenters(IvfflatKmeansSupport * support, VectorArray centers, const IvfflatTypeInfo * typeInfo)
 {
 	int			dimensions = centers->dim;
-	FmgrInfo   *normprocinfo = IvfflatOptionalProcInfo(index, IVFFLAT_KMEANS_NORM_PROC);
-	Oid			collation = index->rd_indcollation[0];
 	float	   *x = (float *) palloc(sizeof(float) * dimensions);
 
 	/* Fill with random data */
@@ -144,8 +141,8 @@ RandomCenters(Relation index, VectorArray centers, const IvfflatTypeInfo * typeI
 		centers->length++;
 	}
 
-	if (normprocinfo != NULL)
-		NormCenters(typeInfo, collation, centers);
+	if (support->normprocinfo != NULL)
+		NormCenters(typeInfo, support->collation, centers);
 }
 
 #ifdef IVFFLAT_MEMORY
@@ -260,11 +257,11 @@ ComputeNewCenters(VectorArray samples, float *agg, VectorArray newCenters, int *
  * https://www.aaai.org/Papers/ICML/2003/ICML03-022.pdf
  */
 static void
-ElkanKmeans(Relation index, VectorArray samples, VectorArray centers, const IvfflatTypeInfo * typeInfo)
+ElkanKmeans(IvfflatKmeansSupport * support, VectorArray samples, VectorArray centers, const IvfflatTypeInfo * typeInfo, int maxIterations)
 {
-	FmgrInfo   *procinfo;
-	FmgrInfo   *normprocinfo;
-	Oid			collation;
+	FmgrInfo   *procinfo = support->procinfo;
+	FmgrInfo   *normprocinfo = support->normprocinfo;
+	Oid			collation = support->collation;
 	int			dimensions = centers->dim;
 	int			numCenters = centers->maxlen;
 	int			numSamples = samples->length;
@@ -279,7 +276,7 @@ ElkanKmeans(Relation index, VectorArray samples, VectorArray centers, const Ivff
 	float	   *newcdist;
 
 	/* Calculate allocation sizes */
-	Size		samplesSize = VECTOR_ARRAY_SIZE(samples->maxlen, samples->itemsize);
+	Size		samplesSize = VECTOR_ARRAY_SIZE(samples->length, samples->itemsize);
 	Size		centersSize = VECTOR_ARRAY_SIZE(centers->maxlen, centers->itemsize);
 	Size		newCentersSize = VECTOR_ARRAY_SIZE(numCenters, centers->itemsize);
 	Size		aggSize = sizeof(float) * (int64) numCenters * dimensions;
@@ -306,11 +303,6 @@ ElkanKmeans(Relation index, VectorArray samples, VectorArray centers, const Ivff
 	if (numCenters * numCenters > INT_MAX)
 		elog(ERROR, "Indexing overflow detected. Please report a bug.");
 
-	/* Set support functions */
-	procinfo = index_getprocinfo(index, 1, IVFFLAT_KMEANS_DISTANCE_PROC);
-	normprocinfo = IvfflatOptionalProcInfo(index, IVFFLAT_KMEANS_NORM_PROC);
-	collation = index->rd_indcollation[0];
-
 	/* Allocate space */
 	/* Use float instead of double to save memory */
 	agg = palloc(aggSize);
@@ -331,7 +323,7 @@ ElkanKmeans(Relation index, VectorArray samples, VectorArray centers, const Ivff
 #endif
 
 	/* Pick initial centers */
-	InitCenters(index, samples, centers, lowerBound);
+	InitCenters(support, samples, centers, lowerBound);
 
 	/* Assign each x to its closest initial center c(x) = argmin d(x,c) */
 	for (int64 j = 0; j < numSamples; j++)
@@ -356,8 +348,7 @@ ElkanKmeans(Relation index, VectorArray samples, VectorArray centers, const Ivff
 		closestCenters[j] = closestCenter;
 	}
 
-	/* Give 500 iterations to converge */
-	for (int iteration = 0; iteration < 500; iteration++)
+	for (int iteration = 0; iteration < maxIterations; iteration++)
 	{
 		int			changes = 0;
 		bool		rjreset;
@@ -528,11 +519,11 @@ CheckElements(VectorArray centers, const IvfflatTypeInfo * typeInfo)
  * Ensure no zero vectors for cosine distance
  */
 static void
-CheckNorms(VectorArray centers, Relation index)
+CheckNorms(VectorArray centers, IvfflatKmeansSupport * support)
 {
 	/* Check NORM_PROC instead of KMEANS_NORM_PROC */
-	FmgrInfo   *normprocinfo = IvfflatOptionalProcInfo(index, IVFFLAT_NORM_PROC);
-	Oid			collation = index->rd_indcollation[0];
+	FmgrInfo   *normprocinfo = support->checknormprocinfo;
+	Oid			collation = support->collation;
 
 	if (normprocinfo == NULL)
 		return;
@@ -550,21 +541,20 @@ CheckNorms(VectorArray centers, Relation index)
  * Detect issues with centers
  */
 static void
-CheckCenters(Relation index, VectorArray centers, const IvfflatTypeInfo * typeInfo)
+CheckCenters(IvfflatKmeansSupport * support, VectorArray centers, const IvfflatTypeInfo * typeInfo)
 {
 	if (centers->length != centers->maxlen)
 		elog(ERROR, "Not enough centers. Please report a bug.");
 
 	CheckElements(centers, typeInfo);
-	CheckNorms(centers, index);
+	CheckNorms(centers, support);
 }
 
 /*
- * Perform naive k-means centering
- * We use spherical k-means for inner product and cosine
+ * Perform k-means with the specified support functions
  */
 void
-IvfflatKmeans(Relation index, VectorArray samples, VectorArray centers, const IvfflatTypeInfo * typeInfo)
+IvfflatKmeansWithSupport(IvfflatKmeansSupport * support, VectorArray samples, VectorArray centers, const IvfflatTypeInfo * typeInfo, int maxIterations)
 {
 	MemoryContext kmeansCtx = AllocSetContextCreate(CurrentMemoryContext,
 													"Ivfflat kmeans temporary context",
@@ -572,12 +562,371 @@ IvfflatKmeans(Relation index, VectorArray samples, VectorArray centers, const Iv
 	MemoryContext oldCtx = MemoryContextSwitchTo(kmeansCtx);
 
 	if (samples->length == 0)
-		RandomCenters(index, centers, typeInfo);
+		RandomCenters(support, centers, typeInfo);
 	else
-		ElkanKmeans(index, samples, centers, typeInfo);
+		ElkanKmeans(support, samples, centers, typeInfo, maxIterations);
 
-	CheckCenters(index, centers, typeInfo);
+	CheckCenters(support, centers, typeInfo);
 
 	MemoryContextSwitchTo(oldCtx);
 	MemoryContextDelete(kmeansCtx);
 }
+
+/*
+ * Perform naive k-means centering
+ * We use spherical k-means for inner product and cosine
+ */
+void
+IvfflatKmeans(Relation index, VectorArray samples, VectorArray centers, const IvfflatTypeInfo * typeInfo)
+{
+	IvfflatKmeansSupport support;
+
+	support.procinfo = index_getprocinfo(index, 1, IVFFLAT_KMEANS_DISTANCE_PROC);
+	support.normprocinfo = IvfflatOptionalProcInfo(index, IVFFLAT_KMEANS_NORM_PROC);
+	support.checknormprocinfo = IvfflatOptionalProcInfo(index, IVFFLAT_NORM_PROC);
+	support.collation = index->rd_indcollation[0];
+
+	/* Give 500 iterations to converge */
+	IvfflatKmeansWithSupport(&support, samples, centers, typeInfo, 500);
+}
+
+/*
+ * Aggregate state for vector_kmeans
+ */
+typedef struct KmeansAggState
+{
+	bool		half;
+	Oid			typid;
+	int			k;
+	int			iterations;
+	int			numSamples;
+	double		rows;
+	VectorArray samples;
+}			KmeansAggState;
+
+typedef struct KmeansAggStateData
+{
+	int32		vl_len_;		/* varlena header (do not touch directly!) */
+	bool		half;
+	Oid			typid;
+	int			k;
+	int			iterations;
+	int			dimensions;
+	int			length;
+	double		rows;
+	char		items[FLEXIBLE_ARRAY_MEMBER];
+}			KmeansAggStateData;
+
+PGDLLEXPORT Datum l2_distance(PG_FUNCTION_ARGS);
+PGDLLEXPORT Datum halfvec_l2_distance(PG_FUNCTION_ARGS);
+
+/*
+ * Get the aggregate memory context
+ */
+static MemoryContext
+KmeansAggContext(FunctionCallInfo fcinfo)
+{
+	MemoryContext aggcontext;
+
+	if (!AggCheckCallContext(fcinfo, &aggcontext))
+		elog(ERROR, "vector_kmeans called in non-aggregate context");
+
+	return aggcontext;
+}
+
+/*
+ * Create aggregate state
+ */
+static KmeansAggState *
+CreateKmeansAggState(bool half, Oid typid, int k, int iterations, int dimensions, double rows)
+{
+	const IvfflatTypeInfo *typeInfo = half ? &IvfflatHalfvecTypeInfo : &IvfflatVectorTypeInfo;
+	KmeansAggState *state = palloc(sizeof(KmeansAggState));
+
+	state->half = half;
+	state->typid = typid;
+	state->k = k;
+	state->iterations = iterations;
+	/* Target 50 samples per center, with at least 10000 samples like index builds */
+	state->numSamples = Max(k * 50, 10000);
+	state->rows = rows;
+	/* Grow the sample as needed since the input may be small */
+	state->samples = VectorArrayInit(Min(state->numSamples, 1024), dimensions, typeInfo->itemSize(dimensions));
+	return state;
+}
+
+/*
+ * Grow the sample to hold more items
+ */
+static void
+GrowKmeansSamples(VectorArray samples, int maxlen)
+{
+	/* Stays in the context of the items */
+	samples->items = repalloc_huge(samples->items, (Size) maxlen * samples->itemsize);
+	memset(samples->items + (Size) samples->maxlen * samples->itemsize, 0, (Size) (maxlen - samples->maxlen) * samples->itemsize);
+	samples->maxlen = maxlen;
+}
+
+/*
+ * Add a value to the state with reservoir sampling
+ */
+static KmeansAggState *
+KmeansAccum(FunctionCallInfo fcinfo, bool half)
+{
+	MemoryContext aggcontext = KmeansAggContext(fcinfo);
+	KmeansAggState *state = PG_ARGISNULL(0) ? NULL : (KmeansAggState *) PG_GETARG_POINTER(0);
+	VectorArray samples;
+	Pointer		value;
+	int			dimensions;
+
+	if (PG_ARGISNULL(1))
+		return state;
+
+	value = PG_DETOAST_DATUM(PG_GETARG_DATUM(1));
+	dimensions = half ? ((HalfVector *) value)->dim : ((Vector *) value)->dim;
+
+	if (state == NULL)
+	{
+		int			k;
+		int			iterations = 500;
+		MemoryContext oldCtx;
+
+		if (PG_ARGISNULL(2))
+			ereport(ERROR,
+					(errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+					 errmsg("k cannot be null")));
+
+		k = PG_GETARG_INT32(2);
+		if (k < 1 || k > IVFFLAT_MAX_LISTS)
+			ereport(ERROR,
+					(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+					 errmsg("k must be between 1 and %d", IVFFLAT_MAX_LISTS)));
+
+		if (PG_NARGS() > 3 && !PG_ARGISNULL(3))
+		{
+			iterations = PG_GETARG_INT32(3);
+			if (iterations < 1)
+				ereport(ERROR,
+						(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+						 errmsg("iterations must be greater than zero")));
+		}
+
+		oldCtx = MemoryContextSwitchTo(aggcontext);
+		state = CreateKmeansAggState(half, get_fn_expr_argtype(fcinfo->flinfo, 1), k, iterations, dimensions, 0);
+		MemoryContextSwitchTo(oldCtx);
+	}
+	else if (dimensions != state->samples->dim)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_EXCEPTION),
+				 errmsg("different vector dimensions %d and %d", state->samples->dim, dimensions)));
+
+	samples = state->samples;
+	state->rows += 1;
+
+	if (samples->length < state->numSamples)
+	{
+		if (samples->length == samples->maxlen)
+			GrowKmeansSamples(samples, Min(samples->maxlen * 2, state->numSamples));
+
+		VectorArraySet(samples, samples->length, value);
+		samples->length++;
+	}
+	else
+	{
+		int64		j = (int64) (RandomDouble() * state->rows);
+
+		if (j < state->numSamples)
+			VectorArraySet(samples, j, value);
+	}
+
+	return state;
+}
+
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(vector_kmeans_accum);
+Datum
+vector_kmeans_accum(PG_FUNCTION_ARGS)
+{
+	KmeansAggState *state = KmeansAccum(fcinfo, false);
+
+	if (state == NULL)
+		PG_RETURN_NULL();
+
+	PG_RETURN_POINTER(state);
+}
+
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(halfvec_kmeans_accum);
+Datum
+halfvec_kmeans_accum(PG_FUNCTION_ARGS)
+{
+	KmeansAggState *state = KmeansAccum(fcinfo, true);
+
+	if (state == NULL)
+		PG_RETURN_NULL();
+
+	PG_RETURN_POINTER(state);
+}
+
+/*
+ * Combine states by sampling from each in proportion to the rows seen
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(vector_kmeans_combine);
+Datum
+vector_kmeans_combine(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggcontext = KmeansAggContext(fcinfo);
+	KmeansAggState *state1 = PG_ARGISNULL(0) ? NULL : (KmeansAggState *) PG_GETARG_POINTER(0);
+	KmeansAggState *state2 = PG_ARGISNULL(1) ? NULL : (KmeansAggState *) PG_GETARG_POINTER(1);
+	VectorArray samples1;
+	VectorArray samples2;
+	VectorArray merged;
+	int			length1;
+	int			length2;
+	MemoryContext oldCtx;
+
+	if (state2 == NULL)
+	{
+		if (state1 == NULL)
+			PG_RETURN_NULL();
+
+		PG_RETURN_POINTER(state1);
+	}
+
+	if (state1 == NULL)
+		PG_RETURN_POINTER(state2);
+
+	samples1 = state1->samples;
+	samples2 = state2->samples;
+
+	if (samples1->dim != samples2->dim)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_EXCEPTION),
+				 errmsg("different vector dimensions %d and %d", samples1->dim, samples2->dim)));
+
+	length1 = samples1->length;
+	length2 = samples2->length;
+
+	oldCtx = MemoryContextSwitchTo(aggcontext);
+	merged = VectorArrayInit(Min(length1 + length2, state1->numSamples), samples1->dim, samples1->itemsize);
+	MemoryContextSwitchTo(oldCtx);
+
+	while (merged->length < merged->maxlen && (length1 > 0 || length2 > 0))
+	{
+		bool		first = length2 == 0 || (length1 > 0 && RandomDouble() * (state1->rows + state2->rows) < state1->rows);
+		VectorArray src = first ? samples1 : samples2;
+		int		   *length = first ? &length1 : &length2;
+		int			j = RandomInt() % *length;
+
+		VectorArraySet(merged, merged->length, VectorArrayGet(src, j));
+		merged->length++;
+
+		/* Move the last remaining sample into its place */
+		(*length)--;
+		if (j != *length)
+			memcpy(VectorArrayGet(src, j), VectorArrayGet(src, *length), src->itemsize);
+	}
+
+	VectorArrayFree(samples1);
+	state1->samples = merged;
+	state1->rows += state2->rows;
+
+	PG_RETURN_POINTER(state1);
+}
+
+/*
+ * Serialize the state for parallel aggregation
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(vector_kmeans_serial);
+Datum
+vector_kmeans_serial(PG_FUNCTION_ARGS)
+{
+	KmeansAggState *state = (KmeansAggState *) PG_GETARG_POINTER(0);
+	VectorArray samples = state->samples;
+	Size		size = offsetof(KmeansAggStateData, items) + samples->length * samples->itemsize;
+	KmeansAggStateData *result = palloc(size);
+
+	SET_VARSIZE(result, size);
+	result->half = state->half;
+	result->typid = state->typid;
+	result->k = state->k;
+	result->iterations = state->iterations;
+	result->dimensions = samples->dim;
+	result->length = samples->length;
+	result->rows = state->rows;
+	memcpy(result->items, samples->items, samples->length * samples->itemsize);
+
+	PG_RETURN_BYTEA_P(result);
+}
+
+/*
+ * Deserialize the state for parallel aggregation
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(vector_kmeans_deserial);
+Datum
+vector_kmeans_deserial(PG_FUNCTION_ARGS)
+{
+	MemoryContext aggcontext = KmeansAggContext(fcinfo);
+	KmeansAggStateData *data = (KmeansAggStateData *) PG_GETARG_BYTEA_P(0);
+	KmeansAggState *state;
+	MemoryContext oldCtx;
+
+	oldCtx = MemoryContextSwitchTo(aggcontext);
+	state = CreateKmeansAggState(data->half, data->typid, data->k, data->iterations, data->dimensions, data->rows);
+	MemoryContextSwitchTo(oldCtx);
+
+	if (data->length > state->numSamples)
+		elog(ERROR, "invalid vector_kmeans state");
+
+	if (data->length > state->samples->maxlen)
+		GrowKmeansSamples(state->samples, data->length);
+
+	memcpy(state->samples->items, data->items, data->length * state->samples->itemsize);
+	state->samples->length = data->length;
+
+	PG_RETURN_POINTER(state);
+}
+
+/*
+ * Run k-means on the sample
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(vector_kmeans_final);
+Datum
+vector_kmeans_final(PG_FUNCTION_ARGS)
+{
+	KmeansAggState *state = PG_ARGISNULL(0) ? NULL : (KmeansAggState *) PG_GETARG_POINTER(0);
+	const IvfflatTypeInfo *typeInfo;
+	IvfflatKmeansSupport support;
+	FmgrInfo	procinfo;
+	VectorArray centers;
+	Datum	   *elems;
+	int16		typlen;
+	bool		typbyval;
+	char		typalign;
+
+	if (state == NULL || state->samples->length == 0)
+		PG_RETURN_NULL();
+
+	typeInfo = state->half ? &IvfflatHalfvecTypeInfo : &IvfflatVectorTypeInfo;
+
+	/* Use L2 distance like vector_l2_ops */
+	MemSet(&procinfo, 0, sizeof(FmgrInfo));
+	procinfo.fn_addr = state->half ? halfvec_l2_distance : l2_distance;
+	procinfo.fn_oid = InvalidOid;
+	procinfo.fn_nargs = 2;
+	procinfo.fn_strict = true;
+	procinfo.fn_mcxt = CurrentMemoryContext;
+
+	support.procinfo = &procinfo;
+	support.normprocinfo = NULL;
+	support.checknormprocinfo = NULL;
+	support.collation = InvalidOid;
+
+	centers = VectorArrayInit(state->k, state->samples->dim, state->samples->itemsize);
+	IvfflatKmeansWithSupport(&support, state->samples, centers, typeInfo, state->iterations);
+
+	elems = palloc(sizeof(Datum) * centers->length);
+	for (int i = 0; i < centers->length; i++)
+		elems[i] = PointerGetDatum(VectorArrayGet(centers, i));
+
+	get_typlenbyvalalign(state->typid, &typlen, &typbyval, &typalign);
+	PG_RETURN_ARRAYTYPE_P(construct_array(elems, centers->length, state->typid, typlen, typbyval, typalign));
+}
@@ -1,13 +1,19 @@
 #include "postgres.h"
 
 #include "access/generic_xlog.h"
+#include "bf16utils.h"
+#include "bf16vec.h"
 #include "bitvec.h"
 #include "catalog/pg_type.h"
 #include "fmgr.h"
 #include "halfutils.h"
 #include "halfvec.h"
+#include "int8utils.h"
+#include "int8vec.h"
 #include "ivfflat.h"
+#include "nodes/value.h"
 #include "storage/bufmgr.h"
+#include "utils/varlena.h"
 
 /*
  * Allocate a vector array
@@ -52,6 +58,56 @@ IvfflatGetLists(Relation index)
 	return IVFFLAT_DEFAULT_LISTS;
 }
 
+/*
+ * Get the number of probes
+ */
+int
+IvfflatGetProbes(Relation index)
+{
+	IvfflatOptions *opts = (IvfflatOptions *) index->rd_options;
+
+	/* Index option is the minimum */
+	if (opts && opts->probes > ivfflat_probes)
+		return opts->probes;
+
+	return ivfflat_probes;
+}
+
+/*
+ * Get the source of centers
+ */
+char *
+IvfflatGetCentersFrom(Relation index)
+{
+	IvfflatOptions *opts = (IvfflatOptions *) index->rd_options;
+
+	if (opts && opts->centersFromOffset > 0)
+		return (char *) opts + opts->centersFromOffset;
+
+	return NULL;
+}
+
+/*
+ * Parse the source of centers into a schema-qualified name
+ */
+List *
+IvfflatParseCentersFrom(const char *centersFrom)
+{
+	List	   *idents;
+	List	   *names = NIL;
+	ListCell   *lc;
+
+	if (!SplitIdentifierString(pstrdup(centersFrom), '.', &idents) || list_length(idents) < 2 || list_length(idents) > 3)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("centers_from must be a schema-qualified table or index name")));
+
+	foreach(lc, idents)
+		names = lappend(names, makeString((char *) lfirst(lc)));
+
+	return names;
+}
+
 /*
  * Get proc
  */
@@ -231,6 +287,7 @@ IvfflatUpdateList(Relation index, ListInfo listInfo,
 
 PGDLLEXPORT Datum l2_normalize(PG_FUNCTION_ARGS);
 PGDLLEXPORT Datum halfvec_l2_normalize(PG_FUNCTION_ARGS);
+PGDLLEXPORT Datum bf16vec_l2_normalize(PG_FUNCTION_ARGS);
 PGDLLEXPORT Datum sparsevec_l2_normalize(PG_FUNCTION_ARGS);
 
 static Size
@@ -245,6 +302,18 @@ HalfvecItemSize(int dimensions)
 	return HALFVEC_SIZE(dimensions);
 }
 
+static Size
+Bf16vecItemSize(int dimensions)
+{
+	return BF16VEC_SIZE(dimensions);
+}
+
+static Size
+Int8vecItemSize(int dimensions)
+{
+	return INT8VEC_SIZE(dimensions);
+}
+
 static Size
 BitItemSize(int dimensions)
 {
@@ -275,6 +344,31 @@ HalfvecUpdateCenter(Pointer v, int dimensions, float *x)
 		vec->x[i] = Float4ToHalfUnchecked(x[i]);
 }
 
+static void
+Bf16vecUpdateCenter(Pointer v, int dimensions, float *x)
+{
+	Bf16Vector *vec = (Bf16Vector *) v;
+
+	SET_VARSIZE(vec, BF16VEC_SIZE(dimensions));
+	vec->dim = dimensions;
+
+	for (int i = 0; i < dimensions; i++)
+		vec->x[i] = Float4ToBf16Unchecked(x[i]);
+}
+
+static void
+Int8vecUpdateCenter(Pointer v, int dimensions, float *x)
+{
+	Int8Vector *vec = (Int8Vector *) v;
+
+	SET_VARSIZE(vec, INT8VEC_SIZE(dimensions));
+	vec->dim = dimensions;
+
+	/* Centers of int8 vectors are always in range */
+	for (int i = 0; i < dimensions; i++)
+		vec->x[i] = Float4ToInt8(x[i]);
+}
+
 static void
 BitUpdateCenter(Pointer v, int dimensions, float *x)
 {
@@ -313,6 +407,28 @@ HalfvecSumCenter(Pointer v, float *x)
 		x[i] += HalfToFloat4(vec->x[i]);
 }
 
+static void
+Bf16vecSumCenter(Pointer v, float *x)
+{
+	Bf16Vector *vec = (Bf16Vector *) v;
+	int			dim = vec->dim;
+
+	/* Auto-vectorized */
+	for (int i = 0; i < dim; i++)
+		x[i] += Bf16ToFloat4(vec->x[i]);
+}
+
+static void
+Int8vecSumCenter(Pointer v, float *x)
+{
+	Int8Vector *vec = (Int8Vector *) v;
+	int			dim = vec->dim;
+
+	/* Auto-vectorized */
+	for (int i = 0; i < dim; i++)
+		x[i] += vec->x[i];
+}
+
 static void
 BitSumCenter(Pointer v, float *x)
 {
@@ -322,6 +438,22 @@ BitSumCenter(Pointer v, float *x)
 		x[i] += (float) (((VARBITS(vec)[i / 8]) >> (7 - (i % 8))) & 0x01);
 }
 
+const		IvfflatTypeInfo IvfflatVectorTypeInfo = {
+	.maxDimensions = IVFFLAT_MAX_DIM,
+	.normalize = l2_normalize,
+	.itemSize = VectorItemSize,
+	.updateCenter = VectorUpdateCenter,
+	.sumCenter = VectorSumCenter
+};
+
+const		IvfflatTypeInfo IvfflatHalfvecTypeInfo = {
+	.maxDimensions = IVFFLAT_MAX_DIM * 2,
+	.normalize = halfvec_l2_normalize,
+	.itemSize = HalfvecItemSize,
+	.updateCenter = HalfvecUpdateCenter,
+	.sumCenter = HalfvecSumCenter
+};
+
 /*
  * Get type info
  */
@@ -331,17 +463,7 @@ IvfflatGetTypeInfo(Relation index)
 	FmgrInfo   *procinfo = IvfflatOptionalProcInfo(index, IVFFLAT_TYPE_INFO_PROC);
 
 	if (procinfo == NULL)
-	{
-		static const IvfflatTypeInfo typeInfo = {
-			.maxDimensions = IVFFLAT_MAX_DIM,
-			.normalize = l2_normalize,
-			.itemSize = VectorItemSize,
-			.updateCenter = VectorUpdateCenter,
-			.sumCenter = VectorSumCenter
-		};
-
-		return (&typeInfo);
-	}
+		return (&IvfflatVectorTypeInfo);
 	else
 		return (const IvfflatTypeInfo *) DatumGetPointer(FunctionCall0Coll(procinfo, InvalidOid));
 }
@@ -349,13 +471,35 @@ IvfflatGetTypeInfo(Relation index)
 FUNCTION_PREFIX PG_FUNCTION_INFO_V1(ivfflat_halfvec_support);
 Datum
 ivfflat_halfvec_support(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_POINTER(&IvfflatHalfvecTypeInfo);
+}
+
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(ivfflat_bf16vec_support);
+Datum
+ivfflat_bf16vec_support(PG_FUNCTION_ARGS)
 {
 	static const IvfflatTypeInfo typeInfo = {
 		.maxDimensions = IVFFLAT_MAX_DIM * 2,
-		.normalize = halfvec_l2_normalize,
-		.itemSize = HalfvecItemSize,
-		.updateCenter = HalfvecUpdateCenter,
-		.sumCenter = HalfvecSumCenter
+		.normalize = bf16vec_l2_normalize,
+		.itemSize = Bf16vecItemSize,
+		.updateCenter = Bf16vecUpdateCenter,
+		.sumCenter = Bf16vecSumCenter
+	};
+
+	PG_RETURN_POINTER(&typeInfo);
+}
+
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(ivfflat_int8vec_support);
+Datum
+ivfflat_int8vec_support(PG_FUNCTION_ARGS)
+{
+	static const IvfflatTypeInfo typeInfo = {
+		.maxDimensions = IVFFLAT_MAX_DIM * 4,
+		.normalize = NULL,
+		.itemSize = Int8vecItemSize,
+		.updateCenter = Int8vecUpdateCenter,
+		.sumCenter = Int8vecSumCenter
 	};
 
 	PG_RETURN_POINTER(&typeInfo);
@@ -0,0 +1,521 @@
+#include "postgres.h"
+
+#include <math.h>
+
+#include "access/table.h"
+#include "access/tableam.h"
+#include "catalog/objectaddress.h"
+#include "catalog/pg_class_d.h"
+#include "executor/tuptable.h"
+#include "fmgr.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "utils/acl.h"
+#include "utils/array.h"
+#include "utils/builtins.h"
+#include "utils/float.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+#include "utils/rls.h"
+#include "utils/snapmgr.h"
+#include "utils/tuplestore.h"
+#include "vector.h"
+
+#if PG_VERSION_NUM >= 160000
+#include "varatt.h"
+#endif
+
+/* Rows scored together (fits in L2 cache for typical dimensions) */
+#define KNN_BLOCK_ROWS	256
+
+/* Queries scored together against each row */
+#define KNN_TILE_QUERIES	4
+
+typedef enum KnnDistance
+{
+	KNN_DISTANCE_L2,
+	KNN_DISTANCE_IP,
+	KNN_DISTANCE_COSINE
+}			KnnDistance;
+
+typedef struct KnnCandidate
+{
+	double		distance;
+	ItemPointerData tid;
+}			KnnCandidate;
+
+/* Max-heap of the k closest rows seen so far */
+typedef struct KnnHeap
+{
+	int			length;
+	KnnCandidate *items;
+}			KnnHeap;
+
+typedef struct KnnState
+{
+	KnnDistance distance;
+	int			dim;
+	int			k;
+	int			numQueries;
+	float	   *queries;		/* padded to a multiple of KNN_TILE_QUERIES */
+	float	   *queryNorms;
+	float	   *rows;
+	float	   *rowNorms;
+	ItemPointerData *tids;
+	KnnHeap    *heaps;
+}			KnnState;
+
+/*
+ * Add a candidate to the heap if it is closer than the farthest one
+ *
+ * NaN distances (cosine with zero vector) sort last like float8
+ */
+static void
+KnnHeapAdd(KnnHeap * heap, int k, double distance, ItemPointer tid)
+{
+	KnnCandidate *items = heap->items;
+	int			i;
+
+	if (heap->length < k)
+	{
+		/* Sift up */
+		i = heap->length++;
+		while (i > 0)
+		{
+			int			parent = (i - 1) / 2;
+
+			if (float8_ge(items[parent].distance, distance))
+				break;
+
+			items[i] = items[parent];
+			i = parent;
+		}
+	}
+	else
+	{
+		if (float8_ge(distance, items[0].distance))
+			return;
+
+		/* Replace root and sift down */
+		i = 0;
+		for (;;)
+		{
+			int			child = 2 * i + 1;
+
+			if (child >= k)
+				break;
+
+			if (child + 1 < k && float8_gt(items[child + 1].distance, items[child].distance))
+				child++;
+
+			if (float8_le(items[child].distance, distance))
+				break;
+
+			items[i] = items[child];
+			i = child;
+		}
+	}
+
+	items[i].distance = distance;
+	items[i].tid = *tid;
+}
+
+/*
+ * Compare candidates
+ */
+static int
+CompareCandidates(const void *a, const void *b)
+{
+	const KnnCandidate *ca = (const KnnCandidate *) a;
+	const KnnCandidate *cb = (const KnnCandidate *) b;
+	int			cmp = float8_cmp_internal(ca->distance, cb->distance);
+
+	if (cmp != 0)
+		return cmp;
+
+	return ItemPointerCompare((ItemPointer) &ca->tid, (ItemPointer) &cb->tid);
+}
+
+/*
+ * Compute squared L2 distance from a row to a tile of queries
+ *
+ * Each element of the row is loaded once for all queries in the tile
+ */
+static void
+L2SquaredTile(int dim, const float *q, const float *x, float *out)
+{
+	const float *q0 = q;
+	const float *q1 = q + dim;
+	const float *q2 = q + 2 * dim;
+	const float *q3 = q + 3 * dim;
+	float		s0 = 0.0;
+	float		s1 = 0.0;
+	float		s2 = 0.0;
+	float		s3 = 0.0;
+
+	/* Auto-vectorized */
+	for (int i = 0; i < dim; i++)
+	{
+		float		xi = x[i];
+		float		d0 = q0[i] - xi;
+		float		d1 = q1[i] - xi;
+		float		d2 = q2[i] - xi;
+		float		d3 = q3[i] - xi;
+
+		s0 += d0 * d0;
+		s1 += d1 * d1;
+		s2 += d2 * d2;
+		s3 += d3 * d3;
+	}
+
+	out[0] = s0;
+	out[1] = s1;
+	out[2] = s2;
+	out[3] = s3;
+}
+
+/*
+ * Compute inner product of a row with a tile of queries
+ */
+static void
+InnerProductTile(int dim, const float *q, const float *x, float *out)
+{
+	const float *q0 = q;
+	const float *q1 = q + dim;
+	const float *q2 = q + 2 * dim;
+	const float *q3 = q + 3 * dim;
+	float		s0 = 0.0;
+	float		s1 = 0.0;
+	float		s2 = 0.0;
+	float		s3 = 0.0;
+
+	/* Auto-vectorized */
+	for (int i = 0; i < dim; i++)
+	{
+		float		xi = x[i];
+
+		s0 += q0[i] * xi;
+		s1 += q1[i] * xi;
+		s2 += q2[i] * xi;
+		s3 += q3[i] * xi;
+	}
+
+	out[0] = s0;
+	out[1] = s1;
+	out[2] = s2;
+	out[3] = s3;
+}
+
+/*
+ * Score a block of rows against all queries
+ */
+static void
+ScoreBlock(KnnState * state, int numRows)
+{
+	int			dim = state->dim;
+
+	for (int q = 0; q < state->numQueries; q += KNN_TILE_QUERIES)
+	{
+		const float *tile = state->queries + (Size) q * dim;
+		int			tileQueries = Min(KNN_TILE_QUERIES, state->numQueries - q);
+
+		for (int r = 0; r < numRows; r++)
+		{
+			const float *x = state->rows + (Size) r * dim;
+			float		scores[KNN_TILE_QUERIES];
+
+			if (state->distance == KNN_DISTANCE_L2)
+				L2SquaredTile(dim, tile, x, scores);
+			else
+				InnerProductTile(dim, tile, x, scores);
+
+			for (int i = 0; i < tileQueries; i++)
+			{
+				double		distance;
+
+				if (state->distance == KNN_DISTANCE_L2)
+					distance = sqrt((double) scores[i]);
+				else if (state->distance == KNN_DISTANCE_IP)
+					distance = (double) -scores[i];
+				else
+				{
+					double		similarity = (double) scores[i] / sqrt((double) state->queryNorms[q + i] * (double) state->rowNorms[r]);
+
+					/* Keep in range */
+					if (similarity > 1)
+						similarity = 1.0;
+					else if (similarity < -1)
+						similarity = -1.0;
+
+					distance = 1.0 - similarity;
+				}
+
+				KnnHeapAdd(&state->heaps[q + i], state->k, distance, &state->tids[r]);
+			}
+		}
+	}
+}
+
+/*
+ * Get the squared norm
+ */
+static float
+SquaredNorm(int dim, const float *x)
+{
+	float		norm = 0.0;
+
+	/* Auto-vectorized */
+	for (int i = 0; i < dim; i++)
+		norm += x[i] * x[i];
+
+	return norm;
+}
+
+/*
+ * Parse the metric
+ */
+static KnnDistance
+GetKnnDistance(const char *name)
+{
+	if (strcmp(name, "l2") == 0)
+		return KNN_DISTANCE_L2;
+	else if (strcmp(name, "ip") == 0)
+		return KNN_DISTANCE_IP;
+	else if (strcmp(name, "cosine") == 0)
+		return KNN_DISTANCE_COSINE;
+
+	ereport(ERROR,
+			(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+			 errmsg("metric must be l2, ip, or cosine")));
+	pg_unreachable();
+}
+
+/*
+ * Load queries into a padded matrix
+ */
+static void
+LoadQueries(KnnState * state, ArrayType *arr)
+{
+	Oid			elemtype = ARR_ELEMTYPE(arr);
+	int16		typlen;
+	bool		typbyval;
+	char		typalign;
+	Datum	   *elems;
+	bool	   *nulls;
+	int			numQueries;
+	int			paddedQueries;
+
+	get_typlenbyvalalign(elemtype, &typlen, &typbyval, &typalign);
+	deconstruct_array(arr, elemtype, typlen, typbyval, typalign, &elems, &nulls, &numQueries);
+
+	if (numQueries == 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("queries must not be empty")));
+
+	paddedQueries = (numQueries + KNN_TILE_QUERIES - 1) / KNN_TILE_QUERIES * KNN_TILE_QUERIES;
+
+	for (int i = 0; i < numQueries; i++)
+	{
+		Vector	   *vec;
+
+		if (nulls[i])
+			ereport(ERROR,
+					(errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+					 errmsg("queries cannot contain nulls")));
+
+		vec = DatumGetVector(elems[i]);
+
+		if (i == 0)
+		{
+			state->dim = vec->dim;
+			state->queries = palloc0(sizeof(float) * paddedQueries * vec->dim);
+			state->queryNorms = palloc0(sizeof(float) * paddedQueries);
+		}
+		else if (vec->dim != state->dim)
+			ereport(ERROR,
+					(errcode(ERRCODE_DATA_EXCEPTION),
+					 errmsg("different vector dimensions %d and %d", state->dim, vec->dim)));
+
+		memcpy(state->queries + (Size) i * state->dim, vec->x, sizeof(float) * state->dim);
+		state->queryNorms[i] = SquaredNorm(state->dim, vec->x);
+	}
+
+	state->numQueries = numQueries;
+}
+
+/*
+ * Open the table and check that the column can be read
+ */
+static Relation
+OpenKnnTable(Oid relid, const char *colname, Oid typid, AttrNumber *attnum)
+{
+	Relation	rel = table_open(relid, AccessShareLock);
+	Oid			userid = GetUserId();
+
+	if (rel->rd_rel->relkind != RELKIND_RELATION && rel->rd_rel->relkind != RELKIND_MATVIEW)
+		ereport(ERROR,
+				(errcode(ERRCODE_WRONG_OBJECT_TYPE),
+				 errmsg("\"%s\" is not a table or materialized view", RelationGetRelationName(rel))));
+
+	*attnum = get_attnum(relid, colname);
+	if (*attnum <= 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_UNDEFINED_COLUMN),
+				 errmsg("column \"%s\" does not exist", colname)));
+
+	if (TupleDescAttr(RelationGetDescr(rel), *attnum - 1)->atttypid != typid)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATATYPE_MISMATCH),
+				 errmsg("column \"%s\" must have type %s", colname, format_type_be(typid))));
+
+	if (pg_class_aclcheck(relid, userid, ACL_SELECT) != ACLCHECK_OK &&
+		pg_attribute_aclcheck(relid, *attnum, userid, ACL_SELECT) != ACLCHECK_OK)
+		aclcheck_error(ACLCHECK_NO_PRIV, get_relkind_objtype(rel->rd_rel->relkind), RelationGetRelationName(rel));
+
+	/* Scanning the heap directly would bypass policies */
+	if (check_enable_rls(relid, InvalidOid, false) == RLS_ENABLED)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("vector_exact_knn does not support row-level security")));
+
+	return rel;
+}
+
+/*
+ * Exact k-nearest neighbor search for many queries in a single scan
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(vector_exact_knn);
+Datum
+vector_exact_knn(PG_FUNCTION_ARGS)
+{
+	Oid			relid = PG_GETARG_OID(0);
+	Name		colname = PG_GETARG_NAME(1);
+	ArrayType  *queries = PG_GETARG_ARRAYTYPE_P(2);
+	int			k = PG_GETARG_INT32(3);
+	KnnDistance distance = GetKnnDistance(text_to_cstring(PG_GETARG_TEXT_PP(4)));
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	TupleDesc	tupdesc;
+	Tuplestorestate *tupstore;
+	MemoryContext oldCtx;
+	MemoryContext tmpCtx;
+	KnnState	state;
+	Relation	rel;
+	AttrNumber	attnum;
+	TableScanDesc scan;
+	TupleTableSlot *slot;
+	int			numRows = 0;
+
+	if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo) || !(rsinfo->allowedModes & SFRM_Materialize))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("set-valued function called in context that cannot accept a set")));
+
+	if (k < 1)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("k must be greater than zero")));
+
+	state.distance = distance;
+	state.k = k;
+	LoadQueries(&state, queries);
+
+	/* Candidates for all queries are kept in memory */
+	if ((Size) k * state.numQueries > MaxAllocSize / sizeof(KnnCandidate))
+		ereport(ERROR,
+				(errcode(ERRCODE_PROGRAM_LIMIT_EXCEEDED),
+				 errmsg("k must be at most %d with %d queries", (int) (MaxAllocSize / sizeof(KnnCandidate) / state.numQueries), state.numQueries)));
+
+	state.rows = palloc(sizeof(float) * KNN_BLOCK_ROWS * state.dim);
+	state.rowNorms = palloc(sizeof(float) * KNN_BLOCK_ROWS);
+	state.tids = palloc(sizeof(ItemPointerData) * KNN_BLOCK_ROWS);
+	state.heaps = palloc(sizeof(KnnHeap) * state.numQueries);
+	for (int i = 0; i < state.numQueries; i++)
+	{
+		state.heaps[i].length = 0;
+		state.heaps[i].items = palloc(sizeof(KnnCandidate) * k);
+	}
+
+	rel = OpenKnnTable(relid, NameStr(*colname), ARR_ELEMTYPE(queries), &attnum);
+
+	tmpCtx = AllocSetContextCreate(CurrentMemoryContext,
+								   "Exact knn temporary context",
+								   ALLOCSET_DEFAULT_SIZES);
+
+	slot = table_slot_create(rel, NULL);
+	scan = table_beginscan(rel, GetActiveSnapshot(), 0, NULL);
+
+	while (table_scan_getnextslot(scan, ForwardScanDirection, slot))
+	{
+		bool		isnull;
+		Datum		value = slot_getattr(slot, attnum, &isnull);
+		Vector	   *vec;
+
+		CHECK_FOR_INTERRUPTS();
+
+		if (isnull)
+			continue;
+
+		/* Detoast in temporary context */
+		oldCtx = MemoryContextSwitchTo(tmpCtx);
+		vec = DatumGetVector(value);
+		MemoryContextSwitchTo(oldCtx);
+
+		if (vec->dim != state.dim)
+			ereport(ERROR,
+					(errcode(ERRCODE_DATA_EXCEPTION),
+					 errmsg("different vector dimensions %d and %d", state.dim, vec->dim)));
+
+		memcpy(state.rows + (Size) numRows * state.dim, vec->x, sizeof(float) * state.dim);
+		if (distance == KNN_DISTANCE_COSINE)
+			state.rowNorms[numRows] = SquaredNorm(state.dim, vec->x);
+		state.tids[numRows] = slot->tts_tid;
+		numRows++;
+
+		if (numRows == KNN_BLOCK_ROWS)
+		{
+			ScoreBlock(&state, numRows);
+			numRows = 0;
+			MemoryContextReset(tmpCtx);
+		}
+	}
+
+	if (numRows > 0)
+		ScoreBlock(&state, numRows);
+
+	table_endscan(scan);
+	ExecDropSingleTupleTableSlot(slot);
+	table_close(rel, AccessShareLock);
+	MemoryContextDelete(tmpCtx);
+
+	/* Return results for each query in order of distance */
+	oldCtx = MemoryContextSwitchTo(rsinfo->econtext->ecxt_per_query_memory);
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+	tupstore = tuplestore_begin_heap(true, false, work_mem);
+	rsinfo->returnMode = SFRM_Materialize;
+	rsinfo->setResult = tupstore;
+	rsinfo->setDesc = tupdesc;
+	MemoryContextSwitchTo(oldCtx);
+
+	for (int i = 0; i < state.numQueries; i++)
+	{
+		KnnHeap    *heap = &state.heaps[i];
+
+		qsort(heap->items, heap->length, sizeof(KnnCandidate), CompareCandidates);
+
+		for (int j = 0; j < heap->length; j++)
+		{
+			Datum		values[3];
+			bool		nulls[3] = {false, false, false};
+
+			values[0] = Int32GetDatum(i + 1);
+			values[1] = PointerGetDatum(&heap->items[j].tid);
+			values[2] = Float8GetDatum(heap->items[j].distance);
+			tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+		}
+	}
+
+	return (Datum) 0;
+}
@@ -0,0 +1,246 @@
+#include "postgres.h"
+
+#include "lib/stringinfo.h"
+#include "numautils.h"
+#include "storage/fd.h"
+#include "utils/guc.h"
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#if defined(SYS_mbind) && defined(CPU_SET)
+#define NUMA_SUPPORT
+#endif
+#endif
+
+#ifdef NUMA_SUPPORT
+
+#define NUMA_MAX_NODES 64
+
+#ifndef MPOL_INTERLEAVE
+#define MPOL_INTERLEAVE 3
+#endif
+
+#ifndef MPOL_MF_MOVE
+#define MPOL_MF_MOVE (1 << 1)
+#endif
+
+/*
+ * Read a list like "0-3,8" from sysfs
+ */
+static int
+NumaReadList(const char *path, bool *set, int max)
+{
+	FILE	   *file = AllocateFile(path, "r");
+	char		buf[1024];
+	char	   *p;
+	int			count = 0;
+
+	memset(set, 0, sizeof(bool) * max);
+
+	if (file == NULL)
+		return 0;
+
+	if (fgets(buf, sizeof(buf), file) == NULL)
+	{
+		FreeFile(file);
+		return 0;
+	}
+
+	FreeFile(file);
+
+	p = buf;
+	while (*p != '\0' && *p != '\n')
+	{
+		char	   *end;
+		long		start = strtol(p, &end, 10);
+		long		stop = start;
+
+		if (end == p)
+			break;
+
+		if (*end == '-')
+		{
+			p = end + 1;
+			stop = strtol(p, &end, 10);
+			if (end == p)
+				break;
+		}
+
+		for (long i = start; i <= stop && i < max; i++)
+		{
+			if (i >= 0 && !set[i])
+			{
+				set[i] = true;
+				count++;
+			}
+		}
+
+		p = end;
+		if (*p == ',')
+			p++;
+	}
+
+	return count;
+}
+
+/*
+ * Report the pages of an area on each NUMA node
+ */
+static void
+NumaReportPlacement(char *start, char *end)
+{
+	FILE	   *file;
+	char		line[4096];
+	bool		lineStart = true;
+	unsigned long pages[NUMA_MAX_NODES] = {0};
+	StringInfoData buf;
+
+	file = AllocateFile("/proc/self/numa_maps", "r");
+	if (file == NULL)
+		return;
+
+	while (fgets(line, sizeof(line), file) != NULL)
+	{
+		bool		isStart = lineStart;
+		unsigned long address;
+
+		lineStart = strchr(line, '\n') != NULL;
+
+		/* mbind splits the mapping at the area boundaries */
+		if (!isStart || sscanf(line, "%lx ", &address) != 1 ||
+			address < (unsigned long) start || address >= (unsigned long) end)
+			continue;
+
+		/* Pages per node are listed like N0=123 */
+		for (char *p = strstr(line, " N"); p != NULL; p = strstr(p + 1, " N"))
+		{
+			int			node;
+			unsigned long count;
+
+			if (sscanf(p, " N%d=%lu", &node, &count) == 2 && node >= 0 && node < NUMA_MAX_NODES)
+				pages[node] += count;
+		}
+	}
+
+	FreeFile(file);
+
+	initStringInfo(&buf);
+	for (int i = 0; i < NUMA_MAX_NODES; i++)
+	{
+		if (pages[i] > 0)
+			appendStringInfo(&buf, "%sN%d=%lu", buf.len > 0 ? " " : "", i, pages[i]);
+	}
+
+	ereport(DEBUG1,
+			(errmsg("interleaved memory pages across NUMA nodes: %s", buf.len > 0 ? buf.data : "none")));
+
+	pfree(buf.data);
+}
+#endif
+
+/*
+ * Interleave pages of a shared area across NUMA nodes
+ *
+ * Every participant reads and writes the whole area, so spreading it evenly
+ * avoids having all accesses from other nodes go to the node that touched it
+ * first. Pages that already exist (like those reserved when the segment was
+ * created) are moved, which only works while no other process maps them.
+ */
+void
+NumaInterleaveMemory(void *area, Size size)
+{
+#ifdef NUMA_SUPPORT
+	bool		nodes[NUMA_MAX_NODES];
+	unsigned long mask[NUMA_MAX_NODES / (sizeof(unsigned long) * 8)] = {0};
+	Size		pageSize = sysconf(_SC_PAGESIZE);
+	char	   *start = (char *) TYPEALIGN(pageSize, area);
+	char	   *end = (char *) TYPEALIGN_DOWN(pageSize, (char *) area + size);
+	int			bits = sizeof(unsigned long) * 8;
+
+	if (NumaReadList("/sys/devices/system/node/online", nodes, NUMA_MAX_NODES) < 2 || end <= start)
+		return;
+
+	for (int i = 0; i < NUMA_MAX_NODES; i++)
+	{
+		if (nodes[i])
+			mask[i / bits] |= 1UL << (i % bits);
+	}
+
+	if (syscall(SYS_mbind, start, end - start, MPOL_INTERLEAVE, mask, NUMA_MAX_NODES + 1, MPOL_MF_MOVE) != 0)
+	{
+		ereport(DEBUG1,
+				(errmsg("could not interleave memory across NUMA nodes: %m")));
+		return;
+	}
+
+	/* Reading numa_maps is not free */
+#if PG_VERSION_NUM >= 140000
+	if (message_level_is_interesting(DEBUG1))
+#else
+	if (log_min_messages <= DEBUG1 || client_min_messages <= DEBUG1)
+#endif
+		NumaReportPlacement(start, end);
+#endif
+}
+
+/*
+ * Run a parallel worker on the CPUs of one NUMA node
+ *
+ * Workers are spread across nodes in turn. Memory a worker allocates
+ * afterwards is local to its node. CPUs outside the current affinity mask
+ * (like those excluded by cgroups) are never added.
+ */
+void
+NumaSetWorkerAffinity(int worker)
+{
+#ifdef NUMA_SUPPORT
+	bool		nodes[NUMA_MAX_NODES];
+	bool		cpus[CPU_SETSIZE];
+	char		path[MAXPGPATH];
+	int			count;
+	int			node = -1;
+	cpu_set_t	current;
+	cpu_set_t	set;
+
+	count = NumaReadList("/sys/devices/system/node/online", nodes, NUMA_MAX_NODES);
+	if (count < 2 || worker < 0)
+		return;
+
+	/* Get the node for the worker */
+	for (int i = 0, n = worker % count; i < NUMA_MAX_NODES; i++)
+	{
+		if (nodes[i] && n-- == 0)
+		{
+			node = i;
+			break;
+		}
+	}
+
+	if (node == -1)
+		return;
+
+	snprintf(path, sizeof(path), "/sys/devices/system/node/node%d/cpulist", node);
+	if (NumaReadList(path, cpus, CPU_SETSIZE) == 0)
+		return;
+
+	if (sched_getaffinity(0, sizeof(current), &current) != 0)
+		return;
+
+	CPU_ZERO(&set);
+	for (int i = 0; i < CPU_SETSIZE; i++)
+	{
+		if (cpus[i] && CPU_ISSET(i, &current))
+			CPU_SET(i, &set);
+	}
+
+	if (CPU_COUNT(&set) == 0)
+		return;
+
+	if (sched_setaffinity(0, sizeof(set), &set) != 0)
+		ereport(DEBUG1,
+				(errmsg("could not set CPU affinity for NUMA node %d: %m", node)));
+#endif
+}
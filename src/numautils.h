@@ -0,0 +1,9 @@
+#ifndef NUMAUTILS_H
+#define NUMAUTILS_H
+
+#include "postgres.h"
+
+void		NumaInterleaveMemory(void *area, Size size);
+void		NumaSetWorkerAffinity(int worker);
+
+#endif
@@ -0,0 +1,278 @@
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "catalog/pg_statistic.h"
+#include "commands/vacuum.h"
+#include "fmgr.h"
+#include "halfvec.h"
+#include "nodes/supportnodes.h"
+#include "optimizer/optimizer.h"
+#include "sparsevec.h"
+#include "utils/lsyscache.h"
+#include "utils/selfuncs.h"
+#include "vector.h"
+
+#if PG_VERSION_NUM >= 180000
+#define vacuum_delay_point() vacuum_delay_point(true)
+#endif
+
+/*
+ * Statistics kind for a sample of values
+ *
+ * Arbitrary value outside the ranges reserved in pg_statistic.h
+ */
+#define STATISTIC_KIND_VECTOR_SAMPLE 8192
+
+/* Limits on the sample, since each value is stored at full width */
+#define VECTOR_SAMPLE_MAX_VALUES 100
+#define VECTOR_SAMPLE_MAX_BYTES (1024 * 1024)
+
+typedef struct VectorAnalyzeData
+{
+	AnalyzeAttrComputeStatsFunc computeStats;
+	void	   *extraData;
+}			VectorAnalyzeData;
+
+/*
+ * Compute standard statistics and add a sample of values
+ */
+static void
+compute_vector_stats(VacAttrStats *stats, AnalyzeAttrFetchFunc fetchfunc, int samplerows, double totalrows)
+{
+	VectorAnalyzeData *data = (VectorAnalyzeData *) stats->extra_data;
+	int			slot = -1;
+	int			maxValues;
+	int			numValues = 0;
+	Size		totalSize = 0;
+	int			step;
+	Datum	   *values;
+	MemoryContext oldCtx;
+
+	stats->extra_data = data->extraData;
+	data->computeStats(stats, fetchfunc, samplerows, totalrows);
+	stats->extra_data = data;
+
+	if (!stats->stats_valid)
+		return;
+
+	for (int i = 0; i < STATISTIC_NUM_SLOTS; i++)
+	{
+		if (stats->stakind[i] == 0)
+		{
+			slot = i;
+			break;
+		}
+	}
+
+	if (slot == -1)
+		return;
+
+	/* Standard statistics skip wide values, so keep a sample regardless */
+#if PG_VERSION_NUM >= 170000
+	maxValues = stats->attstattarget;
+#else
+	maxValues = stats->attr->attstattarget;
+#endif
+
+	if (maxValues <= 0 || samplerows == 0)
+		return;
+
+	maxValues = Min(maxValues, VECTOR_SAMPLE_MAX_VALUES);
+
+	/* Sample rows are in physical order, so spread out the values kept */
+	step = Max(samplerows / maxValues, 1);
+
+	oldCtx = MemoryContextSwitchTo(stats->anl_context);
+	values = palloc(sizeof(Datum) * maxValues);
+
+	for (int i = 0; i < samplerows && numValues < maxValues; i += step)
+	{
+		Datum		value;
+		bool		isnull;
+		struct varlena *copy;
+
+		vacuum_delay_point();
+
+		value = fetchfunc(stats, i, &isnull);
+		if (isnull)
+			continue;
+
+		copy = PG_DETOAST_DATUM_COPY(value);
+
+		totalSize += VARSIZE(copy);
+		if (totalSize > VECTOR_SAMPLE_MAX_BYTES)
+		{
+			pfree(copy);
+			break;
+		}
+
+		values[numValues++] = PointerGetDatum(copy);
+	}
+
+	MemoryContextSwitchTo(oldCtx);
+
+	if (numValues == 0)
+		return;
+
+	stats->stakind[slot] = STATISTIC_KIND_VECTOR_SAMPLE;
+	stats->staop[slot] = InvalidOid;
+	stats->stacoll[slot] = InvalidOid;
+	stats->stavalues[slot] = values;
+	stats->numvalues[slot] = numValues;
+	stats->statypid[slot] = stats->attrtypid;
+	stats->statyplen[slot] = stats->attrtype->typlen;
+	stats->statypbyval[slot] = stats->attrtype->typbyval;
+	stats->statypalign[slot] = stats->attrtype->typalign;
+}
+
+/*
+ * Set up statistics for vector types
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(vector_typanalyze);
+Datum
+vector_typanalyze(PG_FUNCTION_ARGS)
+{
+	VacAttrStats *stats = (VacAttrStats *) PG_GETARG_POINTER(0);
+	VectorAnalyzeData *data;
+
+	if (!std_typanalyze(stats))
+		PG_RETURN_BOOL(false);
+
+	data = palloc(sizeof(VectorAnalyzeData));
+	data->computeStats = stats->compute_stats;
+	data->extraData = stats->extra_data;
+
+	stats->compute_stats = compute_vector_stats;
+	stats->extra_data = data;
+
+	PG_RETURN_BOOL(true);
+}
+
+/*
+ * Get the selectivity of a within function from the sample
+ *
+ * Values with different dimensions are skipped since calling the function
+ * on them would error during planning
+ */
+static Selectivity
+WithinSelectivity(SupportRequestSelectivity *req, int (*dims) (Datum))
+{
+	VariableStatData vardata;
+	Node	   *other;
+	Node	   *threshold;
+	AttStatsSlot sslot;
+	Selectivity selec = DEFAULT_INEQ_SEL;
+
+	if (req->is_join || list_length(req->args) != 3)
+		return selec;
+
+	threshold = estimate_expression_value(req->root, lthird(req->args));
+	if (!IsA(threshold, Const) || ((Const *) threshold)->constisnull)
+		return selec;
+
+	/* Allow the column to be either argument */
+	examine_variable(req->root, linitial(req->args), req->varRelid, &vardata);
+	other = estimate_expression_value(req->root, lsecond(req->args));
+	if (!HeapTupleIsValid(vardata.statsTuple))
+	{
+		ReleaseVariableStats(vardata);
+		examine_variable(req->root, lsecond(req->args), req->varRelid, &vardata);
+		other = estimate_expression_value(req->root, linitial(req->args));
+	}
+
+	/* Calling the function on sample values could leak them */
+	if (HeapTupleIsValid(vardata.statsTuple) && IsA(other, Const) && !((Const *) other)->constisnull &&
+		statistic_proc_security_check(&vardata, req->funcid) &&
+		get_attstatsslot(&sslot, vardata.statsTuple, STATISTIC_KIND_VECTOR_SAMPLE, InvalidOid, ATTSTATSSLOT_VALUES))
+	{
+		Form_pg_statistic stats = (Form_pg_statistic) GETSTRUCT(vardata.statsTuple);
+		Datum		query = ((Const *) other)->constvalue;
+		Datum		radius = ((Const *) threshold)->constvalue;
+		int			queryDims = dims(query);
+		int			matches = 0;
+		int			compared = 0;
+		FmgrInfo	flinfo;
+
+		fmgr_info(req->funcid, &flinfo);
+
+		for (int i = 0; i < sslot.nvalues; i++)
+		{
+			if (dims(sslot.values[i]) != queryDims)
+				continue;
+
+			if (DatumGetBool(FunctionCall3Coll(&flinfo, req->inputcollid, sslot.values[i], query, radius)))
+				matches++;
+
+			compared++;
+		}
+
+		/* Avoid zero so small ranges are not treated as empty */
+		if (compared > 0)
+			selec = (1 - stats->stanullfrac) * (matches + 0.5) / (compared + 1);
+
+		free_attstatsslot(&sslot);
+	}
+
+	ReleaseVariableStats(vardata);
+
+	CLAMP_PROBABILITY(selec);
+
+	return selec;
+}
+
+/*
+ * Handle planner support requests for within functions
+ */
+static Node *
+WithinSupport(Node *rawreq, int (*dims) (Datum))
+{
+	if (IsA(rawreq, SupportRequestSelectivity))
+	{
+		SupportRequestSelectivity *req = (SupportRequestSelectivity *) rawreq;
+
+		req->selectivity = WithinSelectivity(req, dims);
+
+		return (Node *) req;
+	}
+
+	return NULL;
+}
+
+static int
+VectorDims(Datum value)
+{
+	return DatumGetVector(value)->dim;
+}
+
+static int
+HalfvecDims(Datum value)
+{
+	return DatumGetHalfVector(value)->dim;
+}
+
+static int
+SparsevecDims(Datum value)
+{
+	return DatumGetSparseVector(value)->dim;
+}
+
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(vector_within_support);
+Datum
+vector_within_support(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_POINTER(WithinSupport((Node *) PG_GETARG_POINTER(0), VectorDims));
+}
+
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(halfvec_within_support);
+Datum
+halfvec_within_support(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_POINTER(WithinSupport((Node *) PG_GETARG_POINTER(0), HalfvecDims));
+}
+
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(sparsevec_within_support);
+Datum
+sparsevec_within_support(PG_FUNCTION_ARGS)
+{
+	PG_RETURN_POINTER(WithinSupport((Node *) PG_GETARG_POINTER(0), SparsevecDims));
+}
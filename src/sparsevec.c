@@ -1036,6 +1036,30 @@ sparsevec_l1_distance(PG_FUNCTION_ARGS)
 	PG_RETURN_FLOAT8((double) distance);
 }
 
+/*
+ * Check if the L2 distance between two sparse vectors is within a threshold
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(sparsevec_l2_within);
+Datum
+sparsevec_l2_within(PG_FUNCTION_ARGS)
+{
+	Datum		distance = DirectFunctionCall2(sparsevec_l2_distance, PG_GETARG_DATUM(0), PG_GETARG_DATUM(1));
+
+	PG_RETURN_BOOL(DatumGetFloat8(distance) <= PG_GETARG_FLOAT8(2));
+}
+
+/*
+ * Check if the cosine distance between two sparse vectors is within a threshold
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(sparsevec_cosine_within);
+Datum
+sparsevec_cosine_within(PG_FUNCTION_ARGS)
+{
+	Datum		distance = DirectFunctionCall2(sparsevec_cosine_distance, PG_GETARG_DATUM(0), PG_GETARG_DATUM(1));
+
+	PG_RETURN_BOOL(DatumGetFloat8(distance) <= PG_GETARG_FLOAT8(2));
+}
+
 /*
  * Get the L2 norm of a sparse vector
  */
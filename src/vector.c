@@ -2,17 +2,22 @@
 
 #include <math.h>
 
+#include "access/genam.h"
+#include "bf16utils.h"
 #include "bitutils.h"
 #include "bitvec.h"
+#include "catalog/pg_class_d.h"
 #include "catalog/pg_type.h"
 #include "common/shortest_dec.h"
 #include "fmgr.h"
 #include "halfutils.h"
 #include "halfvec.h"
 #include "hnsw.h"
+#include "int8utils.h"
 #include "ivfflat.h"
 #include "lib/stringinfo.h"
 #include "libpq/pqformat.h"
+#include "nodes/primnodes.h"
 #include "port.h"				/* for strtof() */
 #include "sparsevec.h"
 #include "utils/array.h"
@@ -20,6 +25,9 @@
 #include "utils/float.h"
 #include "utils/lsyscache.h"
 #include "utils/numeric.h"
+#include "utils/rel.h"
+#include "utils/relcache.h"
+#include "utils/ruleutils.h"
 #include "vector.h"
 
 #if PG_VERSION_NUM >= 160000
@@ -36,7 +44,7 @@
 #endif
 
 #if PG_VERSION_NUM >= 180000
-PG_MODULE_MAGIC_EXT(.name = "vector",.version = "0.8.1");
+PG_MODULE_MAGIC_EXT(.name = "vector",.version = "0.8.2");
 #else
 PG_MODULE_MAGIC;
 #endif
@@ -48,9 +56,11 @@ PGDLLEXPORT void _PG_init(void);
 void
 _PG_init(void)
 {
+	Bf16vecInit();
 	BitvecInit();
 	HalfvecInit();
 	HnswInit();
+	Int8vecInit();
 	IvfflatInit();
 }
 
@@ -546,7 +556,7 @@ halfvec_to_vector(PG_FUNCTION_ARGS)
 	PG_RETURN_POINTER(result);
 }
 
-VECTOR_TARGET_CLONES static float
+VECTOR_TARGET_CLONES float
 VectorL2SquaredDistance(int dim, float *ax, float *bx)
 {
 	float		distance = 0.0;
@@ -593,7 +603,7 @@ vector_l2_squared_distance(PG_FUNCTION_ARGS)
 	PG_RETURN_FLOAT8((double) VectorL2SquaredDistance(a->dim, a->x, b->x));
 }
 
-VECTOR_TARGET_CLONES static float
+VECTOR_TARGET_CLONES float
 VectorInnerProduct(int dim, float *ax, float *bx)
 {
 	float		distance = 0.0;
@@ -711,7 +721,7 @@ vector_spherical_distance(PG_FUNCTION_ARGS)
 }
 
 /* Does not require FMA, but keep logic simple */
-VECTOR_TARGET_CLONES static float
+VECTOR_TARGET_CLONES float
 VectorL1Distance(int dim, float *ax, float *bx)
 {
 	float		distance = 0.0;
@@ -738,6 +748,112 @@ l1_distance(PG_FUNCTION_ARGS)
 	PG_RETURN_FLOAT8((double) VectorL1Distance(a->dim, a->x, b->x));
 }
 
+/*
+ * Check if the L2 distance between two vectors is within a threshold
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(l2_within);
+Datum
+l2_within(PG_FUNCTION_ARGS)
+{
+	Datum		distance = DirectFunctionCall2(l2_distance, PG_GETARG_DATUM(0), PG_GETARG_DATUM(1));
+
+	PG_RETURN_BOOL(DatumGetFloat8(distance) <= PG_GETARG_FLOAT8(2));
+}
+
+/*
+ * Check if the cosine distance between two vectors is within a threshold
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(cosine_within);
+Datum
+cosine_within(PG_FUNCTION_ARGS)
+{
+	Datum		distance = DirectFunctionCall2(cosine_distance, PG_GETARG_DATUM(0), PG_GETARG_DATUM(1));
+
+	PG_RETURN_BOOL(DatumGetFloat8(distance) <= PG_GETARG_FLOAT8(2));
+}
+
+/*
+ * Get the vectors of an array
+ */
+static Vector **
+ArrayGetVectors(ArrayType *array, int *n)
+{
+	int16		typlen;
+	bool		typbyval;
+	char		typalign;
+	Datum	   *elemsp;
+	Vector	  **vectors;
+
+	if (ARR_NDIM(array) > 1)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_EXCEPTION),
+				 errmsg("array must be 1-D")));
+
+	if (ARR_HASNULL(array) && array_contains_nulls(array))
+		ereport(ERROR,
+				(errcode(ERRCODE_NULL_VALUE_NOT_ALLOWED),
+				 errmsg("array must not contain nulls")));
+
+	get_typlenbyvalalign(ARR_ELEMTYPE(array), &typlen, &typbyval, &typalign);
+	deconstruct_array(array, ARR_ELEMTYPE(array), typlen, typbyval, typalign, &elemsp, NULL, n);
+
+	vectors = palloc(sizeof(Vector *) * Max(*n, 1));
+	for (int i = 0; i < *n; i++)
+		vectors[i] = DatumGetVector(elemsp[i]);
+
+	pfree(elemsp);
+
+	return vectors;
+}
+
+/*
+ * Get the late interaction (MaxSim) score of two sets of vectors
+ * Sums the max inner product with the document for each query vector
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(max_sim);
+Datum
+max_sim(PG_FUNCTION_ARGS)
+{
+	ArrayType  *qarray = PG_GETARG_ARRAYTYPE_P(0);
+	ArrayType  *darray = PG_GETARG_ARRAYTYPE_P(1);
+	Vector	  **queries;
+	Vector	  **docs;
+	int			nqueries;
+	int			ndocs;
+	double		score = 0.0;
+
+	queries = ArrayGetVectors(qarray, &nqueries);
+	docs = ArrayGetVectors(darray, &ndocs);
+
+	/* Undefined for an empty set like max() */
+	if (nqueries == 0 || ndocs == 0)
+		PG_RETURN_NULL();
+
+	for (int i = 0; i < ndocs; i++)
+		CheckDims(docs[0], docs[i]);
+
+	for (int i = 0; i < nqueries; i++)
+	{
+		Vector	   *q = queries[i];
+		float		maxSimilarity;
+
+		CheckDims(q, docs[0]);
+
+		maxSimilarity = VectorInnerProduct(q->dim, q->x, docs[0]->x);
+		for (int j = 1; j < ndocs; j++)
+		{
+			float		similarity = VectorInnerProduct(q->dim, q->x, docs[j]->x);
+
+			if (similarity > maxSimilarity)
+				maxSimilarity = similarity;
+		}
+
+		score += maxSimilarity;
+	}
+
+	PG_RETURN_FLOAT8(score);
+}
+
 /*
  * Get the dimensions of a vector
  */
@@ -966,6 +1082,57 @@ binary_quantize(PG_FUNCTION_ARGS)
 	PG_RETURN_VARBIT_P(result);
 }
 
+PGDLLEXPORT Datum halfvec_binary_quantize(PG_FUNCTION_ARGS);
+
+/*
+ * Get the argument of binary_quantize for an index on it
+ */
+FUNCTION_PREFIX PG_FUNCTION_INFO_V1(vector_binary_quantize_arg);
+Datum
+vector_binary_quantize_arg(PG_FUNCTION_ARGS)
+{
+	Oid			indexid = PG_GETARG_OID(0);
+	Relation	index;
+	Node	   *expr = NULL;
+	char	   *result = NULL;
+
+	if (get_rel_relkind(indexid) != RELKIND_INDEX)
+		PG_RETURN_NULL();
+
+	index = index_open(indexid, AccessShareLock);
+
+	if (index->rd_index->indnatts == 1 && index->rd_index->indkey.values[0] == 0)
+		expr = linitial(RelationGetIndexExpressions(index));
+
+	/* Skip length coercion to bit(n) */
+	if (expr != NULL && IsA(expr, FuncExpr) && ((FuncExpr *) expr)->funcformat != COERCE_EXPLICIT_CALL)
+		expr = linitial(((FuncExpr *) expr)->args);
+	else if (expr != NULL && IsA(expr, RelabelType))
+		expr = (Node *) ((RelabelType *) expr)->arg;
+
+	if (expr != NULL && IsA(expr, FuncExpr) && list_length(((FuncExpr *) expr)->args) == 1)
+	{
+		FuncExpr   *func = (FuncExpr *) expr;
+		FmgrInfo	flinfo;
+
+		/* Match the function rather than its name */
+		fmgr_info(func->funcid, &flinfo);
+		if (flinfo.fn_addr == binary_quantize || flinfo.fn_addr == halfvec_binary_quantize)
+		{
+			Oid			heapid = index->rd_index->indrelid;
+
+			result = deparse_expression(linitial(func->args), deparse_context_for(get_rel_name(heapid), heapid), false, false);
+		}
+	}
+
+	index_close(index, AccessShareLock);
+
+	if (result == NULL)
+		PG_RETURN_NULL();
+
+	PG_RETURN_TEXT_P(cstring_to_text(result));
+}
+
 /*
  * Get a subvector
  */
@@ -19,6 +19,9 @@ typedef struct Vector
 Vector	   *InitVector(int dim);
 void		PrintVector(char *msg, Vector * vector);
 int			vector_cmp_internal(Vector * a, Vector * b);
+float		VectorL2SquaredDistance(int dim, float *ax, float *bx);
+float		VectorInnerProduct(int dim, float *ax, float *bx);
+float		VectorL1Distance(int dim, float *ax, float *bx);
 
 /* TODO Move to better place */
 #if PG_VERSION_NUM >= 160000
@@ -0,0 +1,62 @@
+SELECT '[1,2,3]'::bf16vec;
+SELECT '[-1,-2,-3]'::bf16vec;
+SELECT ' [ 1,  2 ,    3  ] '::bf16vec;
+SELECT '[1.23456]'::bf16vec;
+SELECT '[100000,-100000]'::bf16vec;
+SELECT '[hello,1]'::bf16vec;
+SELECT '[NaN,1]'::bf16vec;
+SELECT '[Infinity,1]'::bf16vec;
+SELECT '[3.4e38,1]'::bf16vec;
+SELECT '[4e38,1]'::bf16vec;
+SELECT '[1,2,3'::bf16vec;
+SELECT '[1,2,3]9'::bf16vec;
+SELECT '[]'::bf16vec;
+
+SELECT '[1,2,3]'::bf16vec(3);
+SELECT '[1,2,3]'::bf16vec(2);
+SELECT '[1,2,3]'::bf16vec(0);
+SELECT '[1,2,3]'::bf16vec(16001);
+
+SELECT '[1,2,3]'::bf16vec::vector;
+SELECT '[1.1,2,3]'::vector::bf16vec;
+SELECT l2_norm('[3,4]'::vector);
+SELECT '[1,2,3]'::bf16vec::halfvec;
+SELECT '[1,2,3]'::halfvec::bf16vec;
+SELECT '[100000]'::bf16vec::halfvec;
+SELECT '[1,2,3]'::bf16vec::real[];
+SELECT '{1,2,3}'::real[]::bf16vec;
+SELECT '{1,2,3}'::real[]::bf16vec(2);
+
+SELECT '[1,2,3]'::bf16vec < '[1,2]';
+SELECT '[1,2,3]'::bf16vec <= '[1,2,3]';
+SELECT '[1,2,3]'::bf16vec = '[1,2,3]';
+SELECT '[1,2,3]'::bf16vec != '[1,2,3]';
+SELECT '[1,2,3]'::bf16vec >= '[1,2]';
+SELECT '[1,2,3]'::bf16vec > '[1,2,3]';
+SELECT bf16vec_cmp('[1,2]', '[1,2,3]');
+SELECT bf16vec_cmp('[2,3]', '[1,2,3]');
+
+SELECT vector_dims('[1,2,3]'::bf16vec);
+SELECT l2_norm('[3,4]'::bf16vec);
+
+SELECT l2_distance('[0,0]'::bf16vec, '[3,4]');
+SELECT l2_distance('[1,2]'::bf16vec, '[3]');
+SELECT l2_distance('[1,1,1,1,1,1,1,1,1]'::bf16vec, '[1,1,1,1,1,1,1,4,5]');
+SELECT '[0,0]'::bf16vec <-> '[3,4]';
+
+SELECT inner_product('[1,2]'::bf16vec, '[3,4]');
+SELECT inner_product('[1,1,1,1,1,1,1,1,1]'::bf16vec, '[1,2,3,4,5,6,7,8,9]');
+SELECT '[1,2]'::bf16vec <#> '[3,4]';
+
+SELECT cosine_distance('[1,2]'::bf16vec, '[2,4]');
+SELECT cosine_distance('[1,2]'::bf16vec, '[0,0]');
+SELECT cosine_distance('[1,0]'::bf16vec, '[0,2]');
+SELECT cosine_distance('[1,1]'::bf16vec, '[-1,-1]');
+SELECT '[1,2]'::bf16vec <=> '[2,4]';
+
+SELECT l1_distance('[0,0]'::bf16vec, '[3,4]');
+SELECT l1_distance('[1,2,3,4,5,6,7,8,9]'::bf16vec, '[0,3,2,5,4,7,6,9,8]');
+SELECT '[0,0]'::bf16vec <+> '[3,4]';
+
+SELECT l2_normalize('[3,0]'::bf16vec);
+SELECT l2_normalize('[0,0]'::bf16vec);
@@ -113,6 +113,11 @@ SELECT l1_distance('[1,2,3,4,5,6,7,8,9]'::halfvec, '[1,2,3,4,5,6,7,8,9]');
 SELECT l1_distance('[1,2,3,4,5,6,7,8,9]'::halfvec, '[0,3,2,5,4,7,6,9,8]');
 SELECT '[0,0]'::halfvec <+> '[3,4]';
 
+SELECT l2_within('[0,0]'::halfvec, '[3,4]', 5);
+SELECT l2_within('[0,0]'::halfvec, '[3,4]', 4.9);
+SELECT cosine_within('[1,2]'::halfvec, '[2,4]', 0);
+SELECT cosine_within('[1,0]'::halfvec, '[0,2]', 0.5);
+
 SELECT l2_normalize('[3,4]'::halfvec);
 SELECT l2_normalize('[3,0]'::halfvec);
 SELECT l2_normalize('[0,0.1]'::halfvec);
@@ -146,3 +151,10 @@ SELECT sum(v) FROM unnest(ARRAY['[1,2,3]'::halfvec, '[3,5,7]', NULL]) v;
 SELECT sum(v) FROM unnest(ARRAY[]::halfvec[]) v;
 SELECT sum(v) FROM unnest(ARRAY['[1,2]'::halfvec, '[3]']) v;
 SELECT sum(v) FROM unnest(ARRAY['[65504]'::halfvec, '[65504]']) v;
+
+SELECT vector_kmeans(v, 1) FROM unnest(ARRAY['[1,2,3]'::halfvec, '[3,5,7]']) v;
+SELECT vector_kmeans(v, 1, 10) FROM unnest(ARRAY['[1,2,3]'::halfvec, '[3,5,7]', NULL]) v;
+SELECT vector_kmeans(v, 1) FROM unnest(ARRAY[]::halfvec[]) v;
+SELECT vector_kmeans(v, 1) FROM unnest(ARRAY['[1,2]'::halfvec, '[3]']) v;
+SELECT vector_kmeans(v, 0) FROM unnest(ARRAY['[1,2,3]'::halfvec]) v;
+SELECT vector_kmeans(v, 1, 0) FROM unnest(ARRAY['[1,2,3]'::halfvec]) v;
@@ -26,6 +26,23 @@ SELECT COUNT(*) FROM (SELECT * FROM t ORDER BY val <%> (SELECT NULL::bit)) t2;
 
 DROP TABLE t;
 
+-- binary quantize
+
+CREATE TABLE t (val vector(3));
+INSERT INTO t (val) VALUES ('[1,-2,3]'), ('[1,-1,3]'), ('[-1,2,-3]'), ('[2,-2,4]'), (NULL);
+CREATE INDEX idx ON t USING hnsw ((binary_quantize(val)::bit(3)) bit_hamming_ops);
+
+SELECT t.val, s.distance FROM vector_rerank_search('idx', '[1,-2,3]'::vector, 2) s INNER JOIN t ON t.ctid = s.ctid ORDER BY s.distance;
+
+CREATE SCHEMA s;
+CREATE FUNCTION s.binary_quantize(vector) RETURNS bit AS 'SELECT ~public.binary_quantize($1)' LANGUAGE SQL IMMUTABLE;
+DROP INDEX idx;
+CREATE INDEX idx ON t USING hnsw ((s.binary_quantize(val)::bit(3)) bit_hamming_ops);
+SELECT * FROM vector_rerank_search('idx', '[1,-2,3]'::vector, 2);
+
+DROP TABLE t;
+DROP SCHEMA s CASCADE;
+
 -- varbit
 
 CREATE TABLE t (val varbit(3));
@@ -12,6 +12,21 @@ SELECT * FROM t ORDER BY val <-> '[3,3,3]';
 SELECT COUNT(*) FROM (SELECT * FROM t ORDER BY val <-> (SELECT NULL::vector)) t2;
 SELECT COUNT(*) FROM t;
 
+SET hnsw.analyze_searches = 10;
+ANALYZE t;
+RESET hnsw.analyze_searches;
+SELECT * FROM t ORDER BY val <-> '[3,3,3]';
+
+SELECT vector_autotune('t_val_idx', ARRAY['[3,3,3]'::vector], 1, 1);
+SELECT reloptions FROM pg_class WHERE relname = 't_val_idx';
+SELECT * FROM t ORDER BY val <-> '[3,3,3]';
+
+SELECT index_options, min(recall) AS recall FROM vector_index_advise('t', 'val', 'hnsw') GROUP BY 1 ORDER BY 1;
+SELECT count(*) FROM vector_knn_join('t', 'val', 't_val_idx', 2);
+SELECT t1.val, t2.val, d.distance FROM vector_near_duplicates('t_val_idx', 1) d INNER JOIN t t1 ON t1.ctid = d.ctid1 INNER JOIN t t2 ON t2.ctid = d.ctid2;
+DELETE FROM t WHERE val = '[1,2,4]';
+SELECT COUNT(*) FROM vector_near_duplicates('t_val_idx', 1);
+
 TRUNCATE t;
 SELECT * FROM t ORDER BY val <-> '[3,3,3]';
 
@@ -77,6 +92,71 @@ RESET hnsw.iterative_scan;
 RESET hnsw.ef_search;
 DROP TABLE t;
 
+-- hybrid
+
+CREATE TABLE t (val vector(3), sval sparsevec(3));
+INSERT INTO t (val, sval) VALUES ('[1,1,1]', '{1:1}/3'), ('[1,1,3]', '{1:4}/3'), ('[3,1,1]', '{2:9}/3'), ('[1,1,5]', '{1:9}/3');
+CREATE INDEX idx ON t USING hnsw (val vector_l2_ops);
+
+SELECT t.val, s.score FROM vector_hybrid_search('idx', '[1,1,1]'::vector, 'sval', '{1:1}/3', 2) s INNER JOIN t ON t.ctid = s.ctid ORDER BY s.score;
+
+DROP TABLE t;
+
+-- projection
+
+CREATE TABLE t (val vector(4));
+INSERT INTO t (val) VALUES ('[1,2,3,4]'), ('[5,6,7,8]'), ('[-1,0,1,2]'), (NULL);
+CREATE INDEX ON t USING hnsw (val vector_l2_ops) WITH (project_dimensions = 2);
+
+INSERT INTO t (val) VALUES ('[4,3,2,1]');
+
+SELECT * FROM t ORDER BY val <-> '[4,3,2,1]' LIMIT 1;
+SELECT COUNT(*) FROM (SELECT * FROM t ORDER BY val <-> '[1,1,1,1]') t2;
+SELECT * FROM t ORDER BY val <-> '[1,1,1]';
+
+ALTER INDEX t_val_idx SET (project_dimensions = 3);
+SELECT * FROM t ORDER BY val <-> '[4,3,2,1]' LIMIT 1;
+SELECT * FROM vector_near_duplicates('t_val_idx', 1);
+
+CREATE INDEX ON t USING hnsw (val vector_l2_ops) WITH (project_dimensions = 4);
+CREATE INDEX ON t USING hnsw (val vector_l2_ops) WITH (project_dimensions = 2001);
+CREATE INDEX ON t USING hnsw ((val::halfvec(4)) halfvec_l2_ops) WITH (project_dimensions = 2);
+
+DROP TABLE t;
+
+-- prefix
+
+CREATE TABLE t (val vector(4));
+INSERT INTO t (val) VALUES ('[1,1,0,0]'), ('[1,1,5,5]'), ('[2,2,0,0]'), (NULL);
+CREATE INDEX ON t USING hnsw (val vector_l2_ops) WITH (prefix_dimensions = 2);
+
+INSERT INTO t (val) VALUES ('[0,0,5,5]');
+
+SELECT * FROM t ORDER BY val <-> '[1,1,5,5]';
+SELECT * FROM t ORDER BY val <-> '[1,1,5]';
+
+ALTER INDEX t_val_idx SET (prefix_dimensions = 8);
+SELECT * FROM t ORDER BY val <-> '[1,1,5,5]';
+
+CREATE INDEX ON t USING hnsw (val vector_l2_ops) WITH (prefix_dimensions = 4);
+CREATE INDEX ON t USING hnsw (val vector_l2_ops) WITH (prefix_dimensions = 2, project_dimensions = 2);
+CREATE INDEX ON t USING hnsw ((val::halfvec(4)) halfvec_l2_ops) WITH (prefix_dimensions = 2);
+
+DROP TABLE t;
+
+CREATE TABLE t (val vector(4));
+INSERT INTO t (val) SELECT ARRAY[i * 0.1, 0, (i * 7) % 100, 0] FROM generate_series(1, 100) i;
+CREATE INDEX ON t USING hnsw (val vector_l2_ops) WITH (prefix_dimensions = 2);
+
+SET hnsw.iterative_scan = strict_order;
+SET hnsw.ef_search = 10;
+SELECT * FROM t ORDER BY val <-> '[0,0,0,0]' LIMIT 3;
+SELECT COUNT(*) FROM (SELECT * FROM t ORDER BY val <-> '[0,0,0,0]') t2;
+
+RESET hnsw.iterative_scan;
+RESET hnsw.ef_search;
+DROP TABLE t;
+
 -- unlogged
 
 CREATE UNLOGGED TABLE t (val vector(3));
@@ -95,6 +175,9 @@ CREATE INDEX ON t USING hnsw (val vector_l2_ops) WITH (m = 101);
 CREATE INDEX ON t USING hnsw (val vector_l2_ops) WITH (ef_construction = 3);
 CREATE INDEX ON t USING hnsw (val vector_l2_ops) WITH (ef_construction = 1001);
 CREATE INDEX ON t USING hnsw (val vector_l2_ops) WITH (m = 16, ef_construction = 31);
+CREATE INDEX ON t USING hnsw (val vector_l2_ops) WITH (alpha = 0.9);
+CREATE INDEX ON t USING hnsw (val vector_l2_ops) WITH (alpha = 2.1);
+CREATE INDEX ON t USING hnsw (val vector_l2_ops) WITH (ef_search = 1001);
 
 SHOW hnsw.ef_search;
 
@@ -114,4 +197,9 @@ SHOW hnsw.scan_mem_multiplier;
 SET hnsw.scan_mem_multiplier = 0;
 SET hnsw.scan_mem_multiplier = 1001;
 
+SHOW hnsw.analyze_searches;
+
+SET hnsw.analyze_searches = -1;
+SET hnsw.analyze_searches = 1001;
+
 DROP TABLE t;
@@ -0,0 +1,55 @@
+SELECT '[1,2,3]'::int8vec;
+SELECT '[-128,0,127]'::int8vec;
+SELECT ' [ 1,  2 ,    3  ] '::int8vec;
+SELECT '[128]'::int8vec;
+SELECT '[-129]'::int8vec;
+SELECT '[1.5]'::int8vec;
+SELECT '[hello,1]'::int8vec;
+SELECT '[1,2,3'::int8vec;
+SELECT '[1,2,3]9'::int8vec;
+SELECT '[]'::int8vec;
+
+SELECT '[1,2,3]'::int8vec(3);
+SELECT '[1,2,3]'::int8vec(2);
+SELECT '[1,2,3]'::int8vec(0);
+SELECT '[1,2,3]'::int8vec(16001);
+
+SELECT '[1,-2,3]'::int8vec::vector;
+SELECT '[1.4,-2.6,3]'::vector::int8vec;
+SELECT '[127.6]'::vector::int8vec;
+SELECT '[1,2,3]'::int8vec::integer[];
+SELECT '{1,2,3}'::integer[]::int8vec;
+SELECT '{1,2,300}'::integer[]::int8vec;
+SELECT '{1,2,3}'::integer[]::int8vec(2);
+
+SELECT '[1,2,3]'::int8vec < '[1,2]';
+SELECT '[1,2,3]'::int8vec <= '[1,2,3]';
+SELECT '[1,2,3]'::int8vec = '[1,2,3]';
+SELECT '[1,2,3]'::int8vec != '[1,2,3]';
+SELECT '[1,2,3]'::int8vec >= '[1,2]';
+SELECT '[-1,2,3]'::int8vec > '[1,2,3]';
+SELECT int8vec_cmp('[1,2]', '[1,2,3]');
+SELECT int8vec_cmp('[2,3]', '[1,2,3]');
+
+SELECT vector_dims('[1,2,3]'::int8vec);
+SELECT l2_norm('[3,4]'::int8vec);
+
+SELECT l2_distance('[0,0]'::int8vec, '[3,4]');
+SELECT l2_distance('[1,2]'::int8vec, '[3]');
+SELECT l2_distance('[-128]'::int8vec, '[127]');
+SELECT '[0,0]'::int8vec <-> '[3,4]';
+
+SELECT inner_product('[1,2]'::int8vec, '[3,4]');
+SELECT inner_product('[-128,-128]'::int8vec, '[-128,-128]');
+SELECT inner_product('[1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1,1]'::int8vec, '[1,2,3,4,5,6,7,8,9,10,11,12,13,14,15,16,17]');
+SELECT '[1,2]'::int8vec <#> '[3,4]';
+
+SELECT cosine_distance('[1,2]'::int8vec, '[2,4]');
+SELECT cosine_distance('[1,2]'::int8vec, '[0,0]');
+SELECT cosine_distance('[1,0]'::int8vec, '[0,2]');
+SELECT cosine_distance('[1,1]'::int8vec, '[-1,-1]');
+SELECT '[1,2]'::int8vec <=> '[2,4]';
+
+SELECT l1_distance('[0,0]'::int8vec, '[3,4]');
+SELECT l1_distance('[-128,127]'::int8vec, '[127,-128]');
+SELECT '[0,0]'::int8vec <+> '[3,4]';
@@ -11,6 +11,7 @@ INSERT INTO t (val) VALUES ('[1,2,4]');
 SELECT * FROM t ORDER BY val <-> '[3,3,3]';
 SELECT COUNT(*) FROM (SELECT * FROM t ORDER BY val <-> (SELECT NULL::vector)) t2;
 SELECT COUNT(*) FROM t;
+SELECT t1.val, t2.val, d.distance FROM vector_near_duplicates('t_val_idx', 1) d INNER JOIN t t1 ON t1.ctid = d.ctid1 INNER JOIN t t2 ON t2.ctid = d.ctid2;
 
 TRUNCATE t;
 SELECT * FROM t ORDER BY val <-> '[3,3,3]';
@@ -66,6 +67,29 @@ RESET ivfflat.iterative_scan;
 RESET ivfflat.max_probes;
 DROP TABLE t;
 
+-- centers
+
+CREATE TABLE t (val vector(3));
+INSERT INTO t (val) VALUES ('[0,0,0]'), ('[1,2,3]'), ('[1,1,1]'), (NULL);
+CREATE TABLE c (val vector);
+INSERT INTO c (val) VALUES ('[0,0,0]'), ('[3,3,3]');
+CREATE INDEX idx ON t USING ivfflat (val vector_l2_ops) WITH (lists = 2, centers_from = 'public.c');
+
+SELECT * FROM t ORDER BY val <-> '[3,3,3]';
+
+DROP TABLE c;
+CREATE INDEX ON t USING ivfflat (val vector_l2_ops) WITH (lists = 2, centers_from = 'c');
+CREATE INDEX ON t USING ivfflat (val vector_l2_ops) WITH (lists = 3, centers_from = 'public.idx');
+UPDATE c SET val = '[1,1]';
+CREATE INDEX ON t USING ivfflat (val vector_l2_ops) WITH (lists = 2, centers_from = 'public.c');
+CREATE INDEX idx2 ON t USING ivfflat (val vector_l2_ops) WITH (lists = 2, centers_from = 'public.idx');
+DROP INDEX idx;
+
+SELECT * FROM t ORDER BY val <-> '[3,3,3]';
+
+DROP TABLE t;
+DROP TABLE c;
+
 -- unlogged
 
 CREATE UNLOGGED TABLE t (val vector(3));
@@ -81,6 +105,7 @@ DROP TABLE t;
 CREATE TABLE t (val vector(3));
 CREATE INDEX ON t USING ivfflat (val vector_l2_ops) WITH (lists = 0);
 CREATE INDEX ON t USING ivfflat (val vector_l2_ops) WITH (lists = 32769);
+CREATE INDEX ON t USING ivfflat (val vector_l2_ops) WITH (probes = 32769);
 
 SHOW ivfflat.probes;
 
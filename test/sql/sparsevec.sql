@@ -125,6 +125,11 @@ SELECT l1_distance('{1:1,3:3,5:5,7:7}/8'::sparsevec, '{2:2,4:4,6:6,8:8}/8');
 SELECT l1_distance('{1:1,3:3,5:5,7:7,9:9}/9'::sparsevec, '{2:2,4:4,6:6,8:8}/9');
 SELECT '{}/2'::sparsevec <+> '{1:3,2:4}/2';
 
+SELECT l2_within('{}/2'::sparsevec, '{1:3,2:4}/2', 5);
+SELECT l2_within('{}/2'::sparsevec, '{1:3,2:4}/2', 4.9);
+SELECT cosine_within('{1:1,2:2}/2'::sparsevec, '{1:2,2:4}/2', 0);
+SELECT cosine_within('{1:1}/2'::sparsevec, '{2:2}/2', 0.5);
+
 SELECT l2_normalize('{1:3,2:4}/2'::sparsevec);
 SELECT l2_normalize('{1:3}/2'::sparsevec);
 SELECT l2_normalize('{2:0.1}/2'::sparsevec);
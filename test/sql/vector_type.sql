@@ -120,6 +120,17 @@ SELECT l1_distance('[1,2,3,4,5,6,7,8,9]'::vector, '[1,2,3,4,5,6,7,8,9]');
 SELECT l1_distance('[1,2,3,4,5,6,7,8,9]'::vector, '[0,3,2,5,4,7,6,9,8]');
 SELECT '[0,0]'::vector <+> '[3,4]';
 
+SELECT l2_within('[0,0]'::vector, '[3,4]', 5);
+SELECT l2_within('[0,0]'::vector, '[3,4]', 4.9);
+SELECT l2_within('[1,2]'::vector, '[3]', 1);
+SELECT cosine_within('[1,2]'::vector, '[2,4]', 0);
+SELECT cosine_within('[1,0]'::vector, '[0,2]', 0.5);
+
+SELECT max_sim(ARRAY['[1,0]', '[0,1]']::vector[], ARRAY['[1,2]', '[3,1]']::vector[]);
+SELECT max_sim(ARRAY['[1,0]']::vector[], '{}'::vector[]);
+SELECT max_sim('{}'::vector[], ARRAY['[1,2]']::vector[]);
+SELECT max_sim(ARRAY['[1,0]']::vector[], ARRAY['[1,2,3]']::vector[]);
+
 SELECT l2_normalize('[3,4]'::vector);
 SELECT l2_normalize('[3,0]'::vector);
 SELECT l2_normalize('[0,0.1]'::vector);
@@ -153,3 +164,21 @@ SELECT sum(v) FROM unnest(ARRAY['[1,2,3]'::vector, '[3,5,7]', NULL]) v;
 SELECT sum(v) FROM unnest(ARRAY[]::vector[]) v;
 SELECT sum(v) FROM unnest(ARRAY['[1,2]'::vector, '[3]']) v;
 SELECT sum(v) FROM unnest(ARRAY['[3e38]'::vector, '[3e38]']) v;
+
+SELECT vector_kmeans(v, 1) FROM unnest(ARRAY['[1,2,3]'::vector, '[3,5,7]']) v;
+SELECT vector_kmeans(v, 1, 10) FROM unnest(ARRAY['[1,2,3]'::vector, '[3,5,7]', NULL]) v;
+SELECT vector_kmeans(v, 1) FROM unnest(ARRAY[]::vector[]) v;
+SELECT vector_kmeans(v, 1) FROM unnest(ARRAY['[1,2]'::vector, '[3]']) v;
+SELECT vector_kmeans(v, 0) FROM unnest(ARRAY['[1,2,3]'::vector]) v;
+SELECT vector_kmeans(v, 1, 0) FROM unnest(ARRAY['[1,2,3]'::vector]) v;
+
+CREATE TABLE t (val vector(3));
+INSERT INTO t (val) VALUES ('[0,0,0]'), ('[1,2,3]'), ('[1,1,1]'), (NULL);
+SELECT k.query, t.val, round(k.distance::numeric, 3) AS distance FROM vector_exact_knn('t', 'val', ARRAY['[3,3,3]', '[0,0,1]']::vector[], 2) k INNER JOIN t ON t.ctid = k.ctid ORDER BY k.query, k.distance;
+SELECT k.query, t.val, round(k.distance::numeric, 3) AS distance FROM vector_exact_knn('t', 'val', ARRAY['[3,3,3]']::vector[], 1, 'cosine') k INNER JOIN t ON t.ctid = k.ctid ORDER BY k.query, k.distance;
+SELECT k.query, t.val, round(k.distance::numeric, 3) AS distance FROM vector_exact_knn('t', 'val', ARRAY['[3,3,3]']::vector[], 3, 'cosine') k INNER JOIN t ON t.ctid = k.ctid ORDER BY k.query, k.distance;
+SELECT * FROM vector_exact_knn('t', 'val', ARRAY['[1,2]']::vector[], 1);
+SELECT * FROM vector_exact_knn('t', 'val', ARRAY['[1,2,3]']::vector[], 0);
+SELECT * FROM vector_exact_knn('t', 'val', ARRAY['[1,2,3]', '[3,2,1]']::vector[], 2147483647);
+SELECT * FROM vector_exact_knn('t', 'val', ARRAY['[1,2,3]']::vector[], 1, 'l1');
+DROP TABLE t;
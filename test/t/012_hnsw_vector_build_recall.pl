@@ -96,6 +96,17 @@ for my $i (0 .. $#operators)
 
 	$node->safe_psql("postgres", "DROP INDEX idx;");
 
+	# Build index with alpha
+	$node->safe_psql("postgres", qq(
+		SET max_parallel_maintenance_workers = 0;
+		CREATE INDEX idx ON tst USING hnsw (v $opclass) WITH (alpha = 1.2);
+	));
+
+	# Test approximate results
+	test_recall($min, $operator);
+
+	$node->safe_psql("postgres", "DROP INDEX idx;");
+
 	# Build index in parallel in memory
 	my ($ret, $stdout, $stderr) = $node->psql("postgres", qq(
 		SET client_min_messages = DEBUG;
@@ -39,6 +39,24 @@ for my $dim (@dims)
 	));
 	like($explain, qr/Index Scan using idx/);
 
+	# Sample searches should change the scan cost
+	$explain = $node->safe_psql("postgres", qq(
+		EXPLAIN SELECT i FROM tst ORDER BY v <-> '$query' LIMIT $limit;
+	));
+	$explain =~ /Index Scan using idx.*cost=[\d.]+\.\.([\d.]+)/;
+	my $default_cost = $1;
+
+	$node->safe_psql("postgres", qq(
+		SET hnsw.analyze_searches = 100;
+		ANALYZE tst;
+	));
+
+	$explain = $node->safe_psql("postgres", qq(
+		EXPLAIN SELECT i FROM tst ORDER BY v <-> '$query' LIMIT $limit;
+	));
+	$explain =~ /Index Scan using idx.*cost=[\d.]+\.\.([\d.]+)/;
+	isnt($1, $default_cost, "sample searches change cost");
+
 	# 3x the rows are needed for distance filters
 	# since the planner uses DEFAULT_INEQ_SEL for the selectivity (should be 1)
 	# Recreate index for performance
@@ -0,0 +1,68 @@
+use strict;
+use warnings FATAL => 'all';
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $dim = 3;
+my $array_sql = join(",", ('random()') x $dim);
+
+# Initialize node
+my $node = PostgreSQL::Test::Cluster->new('node');
+$node->init;
+$node->start;
+
+# Create table
+$node->safe_psql("postgres", "CREATE EXTENSION vector;");
+$node->safe_psql("postgres", "CREATE TABLE tst (i int4, v vector($dim), h halfvec($dim), s sparsevec($dim));");
+$node->safe_psql("postgres",
+	"INSERT INTO tst SELECT i, ARRAY[$array_sql], NULL, NULL FROM generate_series(1, 10000) i;"
+);
+$node->safe_psql("postgres", "UPDATE tst SET h = v, s = v::sparsevec;");
+$node->safe_psql("postgres", "ALTER TABLE tst ALTER COLUMN v SET STATISTICS 1000, ALTER COLUMN h SET STATISTICS 1000, ALTER COLUMN s SET STATISTICS 1000;");
+$node->safe_psql("postgres", "ANALYZE tst;");
+
+sub estimated_rows
+{
+	my ($where) = @_;
+
+	my $explain = $node->safe_psql("postgres", qq(
+		EXPLAIN SELECT i FROM tst WHERE $where;
+	));
+	$explain =~ /rows=(\d+)/;
+	return $1;
+}
+
+sub actual_rows
+{
+	my ($where) = @_;
+
+	return $node->safe_psql("postgres", qq(
+		SELECT COUNT(*) FROM tst WHERE $where;
+	));
+}
+
+for my $column ('v', 'h', 's')
+{
+	for my $threshold (0.3, 0.5, 1)
+	{
+		my $query = $column eq 's' ? "'{1:0.5,2:0.5,3:0.5}/3'" : "'[0.5,0.5,0.5]'";
+		my $where = "l2_within($column, $query, $threshold)";
+
+		my $estimated = estimated_rows($where);
+		my $actual = actual_rows($where);
+
+		# Within a factor of two (default selectivity is fixed at a third)
+		cmp_ok($estimated, '>=', $actual / 2, "$where lower");
+		cmp_ok($estimated, '<=', $actual * 2, "$where upper");
+	}
+}
+
+# Different dimensions in sample
+$node->safe_psql("postgres", "CREATE TABLE tst2 (v vector);");
+$node->safe_psql("postgres", "INSERT INTO tst2 VALUES ('[1,1]'), ('[1,1,1]');");
+$node->safe_psql("postgres", "ANALYZE tst2;");
+my $count = $node->safe_psql("postgres", "SELECT COUNT(*) FROM tst2 WHERE vector_dims(v) = 2 AND l2_within(v, '[1,1]', 1);");
+is($count, 1);
+
+done_testing();
@@ -0,0 +1,41 @@
+use strict;
+use warnings FATAL => 'all';
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $large_sql = "(SELECT ('{' || string_agg((j * 50 + i % 50 + 1)::text || ':' || random()::text, ',' ORDER BY j) || '}/100000') FROM generate_series(0, 999) j)::sparsevec";
+my $small_sql = "('{' || (i % 99999 + 1)::text || ':' || random()::text || '}/100000')::sparsevec";
+
+# Initialize node
+my $node = PostgreSQL::Test::Cluster->new('node');
+$node->init;
+$node->start;
+
+# Create table and index
+$node->safe_psql("postgres", "CREATE EXTENSION vector;");
+$node->safe_psql("postgres", "CREATE TABLE tst (i serial, v sparsevec(100000));");
+$node->safe_psql("postgres", "CREATE INDEX ON tst USING hnsw (v sparsevec_l2_ops);");
+
+# Add elements too large to fit on the same page as their neighbors
+$node->safe_psql("postgres", "INSERT INTO tst (v) SELECT $large_sql FROM generate_series(1, 200) i;");
+
+# Fill the remaining space with small elements
+$node->safe_psql("postgres", "INSERT INTO tst (v) SELECT $small_sql FROM generate_series(1, 8000) i;");
+
+# Get size
+my $size = $node->safe_psql("postgres", "SELECT pg_relation_size('tst_v_idx');");
+
+# Delete large elements and vacuum
+$node->safe_psql("postgres", "DELETE FROM tst WHERE i <= 200;");
+$node->safe_psql("postgres", "VACUUM tst;");
+
+# Insert small elements, which should reuse the split slots
+$node->safe_psql("postgres", "INSERT INTO tst (v) SELECT $small_sql FROM generate_series(1, 200) i;");
+
+# Check size
+# May increase some due to elements with higher levels
+my $new_size = $node->safe_psql("postgres", "SELECT pg_relation_size('tst_v_idx');");
+cmp_ok($new_size, "<=", $size + 3 * 8192, "size does not increase too much");
+
+done_testing();
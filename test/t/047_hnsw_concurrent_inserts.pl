@@ -0,0 +1,57 @@
+use strict;
+use warnings FATAL => 'all';
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $dim = 3;
+
+my $array_sql = join(",", ('random()') x $dim);
+
+# Initialize node
+my $node = PostgreSQL::Test::Cluster->new('node');
+$node->init;
+$node->start;
+
+# Create table and index
+$node->safe_psql("postgres", "CREATE EXTENSION vector;");
+$node->safe_psql("postgres", "CREATE TABLE tst (v vector($dim));");
+$node->safe_psql("postgres",
+	"INSERT INTO tst SELECT ARRAY[$array_sql] FROM generate_series(1, 1000) i;"
+);
+$node->safe_psql("postgres", "CREATE INDEX ON tst USING hnsw (v vector_l2_ops);");
+
+# Run inserts alongside scans, which hold pages in share mode
+$node->pgbench(
+	"--no-vacuum --client=20 --transactions=50",
+	0,
+	[qr{actually processed}],
+	[qr{^$}],
+	"concurrent INSERTs and scans",
+	{
+		"047_hnsw_concurrent_inserts" => "INSERT INTO tst SELECT ARRAY[$array_sql] FROM generate_series(1, 10) i;",
+		"047_hnsw_concurrent_scans" => "SET enable_seqscan = off;\nSELECT v FROM tst ORDER BY v <-> ARRAY[$array_sql]::vector LIMIT 10;"
+	}
+);
+
+my $total = $node->safe_psql("postgres", "SELECT COUNT(*) FROM tst;");
+cmp_ok($total, ">", 1000);
+
+# Check elements are reachable
+my $count = $node->safe_psql("postgres", qq(
+	SET enable_seqscan = off;
+	SET hnsw.ef_search = 1000;
+	SET hnsw.iterative_scan = relaxed_order;
+	SET hnsw.max_scan_tuples = 1000000;
+	SELECT COUNT(*) FROM (SELECT v FROM tst ORDER BY v <-> (SELECT v FROM tst LIMIT 1)) t;
+));
+# Elements may lose all incoming connections with the HNSW algorithm
+cmp_ok($count, ">=", $total * 0.99);
+
+# Check skipped pages do not leave too much unused space
+my $size = $node->safe_psql("postgres", "SELECT pg_relation_size('tst_v_idx');");
+$node->safe_psql("postgres", "CREATE INDEX tst_v_idx2 ON tst USING hnsw (v vector_l2_ops);");
+my $build_size = $node->safe_psql("postgres", "SELECT pg_relation_size('tst_v_idx2');");
+cmp_ok($size, "<=", $build_size * 1.5, "size does not increase too much");
+
+done_testing();
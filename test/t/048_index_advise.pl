@@ -0,0 +1,66 @@
+use strict;
+use warnings FATAL => 'all';
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $dim = 16;
+my $array_sql = join(",", ('random()') x $dim);
+
+# Initialize node
+my $node = PostgreSQL::Test::Cluster->new('node');
+$node->init;
+$node->start;
+
+# Create table
+$node->safe_psql("postgres", "CREATE EXTENSION vector;");
+$node->safe_psql("postgres", "CREATE TABLE tst (i int4, v vector($dim));");
+$node->safe_psql("postgres",
+	"INSERT INTO tst SELECT i, ARRAY[$array_sql] FROM generate_series(1, 20000) i;"
+);
+$node->safe_psql("postgres", "ANALYZE tst;");
+
+# Test HNSW advice
+my $res = $node->safe_psql("postgres", qq(
+	SELECT index_options, search_option, recall, index_size, intrinsic_dimension FROM vector_index_advise('tst', 'v', 'hnsw', sample_size => 5000);
+));
+my @rows = split("\n", $res);
+is(scalar(@rows), 18);
+
+for my $options ('m = 8, ef_construction = 32', 'm = 16, ef_construction = 64', 'm = 32, ef_construction = 128')
+{
+	my @recalls = map { (split(/\|/, $_))[2] } grep { /^\Q$options\E\|/ } @rows;
+	is(scalar(@recalls), 6);
+
+	# More candidates should not reduce recall much and should reach a high recall
+	cmp_ok($recalls[-1], ">=", $recalls[0] - 0.02, "$options recall increases");
+	cmp_ok($recalls[-1], ">=", 0.95, "$options max recall");
+}
+
+# Index size is scaled to the full table
+my ($size) = (split(/\|/, $rows[0]))[3];
+cmp_ok($size, ">", 20000 * $dim * 4);
+
+# Intrinsic dimension of uniform data is close to the number of dimensions
+my ($intrinsic) = (split(/\|/, $rows[0]))[4];
+cmp_ok($intrinsic, ">", $dim / 2);
+cmp_ok($intrinsic, "<", $dim * 2);
+
+# Test IVFFlat advice
+$res = $node->safe_psql("postgres", qq(
+	SELECT index_options, search_option, recall FROM vector_index_advise('tst', 'v', 'ivfflat', sample_size => 5000);
+));
+@rows = split("\n", $res);
+is(scalar(@rows), 9);
+
+# Two calls in the same transaction and a user table with the old sample name
+$res = $node->safe_psql("postgres", qq(
+	CREATE TEMP TABLE vector_index_advise_sample (v vector($dim));
+	BEGIN;
+	SELECT COUNT(*) FROM vector_index_advise('tst', 'v', 'hnsw', sample_size => 1000);
+	SELECT COUNT(*) FROM vector_index_advise('tst', 'v', 'hnsw', sample_size => 1000);
+	COMMIT;
+));
+is($res, "18\n18");
+
+done_testing();
@@ -0,0 +1,36 @@
+use strict;
+use warnings FATAL => 'all';
+use PostgreSQL::Test::Cluster;
+use PostgreSQL::Test::Utils;
+use Test::More;
+
+my $dim = 1536;
+my $rows = 10000;
+
+# Initialize node
+my $node = PostgreSQL::Test::Cluster->new('node');
+$node->init;
+$node->start;
+
+# Create tables and index
+$node->safe_psql("postgres", "CREATE EXTENSION vector;");
+$node->safe_psql("postgres", "CREATE TABLE tst (i int4, v vector($dim));");
+$node->safe_psql("postgres",
+	"INSERT INTO tst SELECT i, (SELECT array_agg(random()) FROM generate_series(1, $dim) WHERE i > 0) FROM generate_series(1, $rows) i;"
+);
+$node->safe_psql("postgres", "CREATE INDEX idx ON tst USING hnsw (v vector_l2_ops);");
+$node->safe_psql("postgres", "ANALYZE tst;");
+
+# Clustering the queries should fit in the default maintenance_work_mem
+my $res = $node->safe_psql("postgres", qq(
+	SET hnsw.ef_search = 100;
+	SELECT COUNT(*), COUNT(DISTINCT query_ctid), COUNT(*) FILTER (WHERE query_ctid = ctid) FROM vector_knn_join('tst', 'v', 'idx', 5);
+));
+my ($count, $queries, $self) = split(/\|/, $res);
+is($count, $rows * 5);
+is($queries, $rows);
+
+# Each row should find itself
+cmp_ok($self, ">=", $rows * 0.99);
+
+done_testing();